@@ -0,0 +1,90 @@
+#include "AnalysisService.h"
+
+AnalysisService::AnalysisService()
+{
+    juce::HighResolutionTimer::startTimer(tickIntervalMs);
+    juce::Timer::startTimer(frameIntervalMs);
+}
+
+AnalysisService::~AnalysisService()
+{
+    juce::HighResolutionTimer::stopTimer();
+    juce::Timer::stopTimer();
+
+    jassert(jobs.isEmpty());
+    pool.removeAllJobs(true, 1000);
+}
+
+void AnalysisService::registerClient(Client& client)
+{
+    const juce::ScopedLock sl(clientsLock);
+
+    auto phase = (int)std::distance(clientsPerPhase.begin(), std::min_element(clientsPerPhase.begin(), clientsPerPhase.end()));
+    ++clientsPerPhase[(size_t)phase];
+
+    jobs.add(new ClientJob(client, phase));
+}
+
+void AnalysisService::unregisterClient(Client& client)
+{
+    const juce::ScopedLock sl(clientsLock);
+
+    for (int i = jobs.size(); --i >= 0;) {
+        auto* job = jobs.getUnchecked(i);
+
+        if (&job->client == &client) {
+            pool.removeJob(job, true, -1);
+            --clientsPerPhase[(size_t)job->phase];
+            jobs.remove(i);
+        }
+    }
+}
+
+std::shared_ptr<const juce::dsp::FFT> AnalysisService::getFFT(int order)
+{
+    const juce::ScopedLock sl(resourcesLock);
+
+    auto& fft = ffts[order];
+    if (fft == nullptr) {
+        fft = std::make_shared<juce::dsp::FFT>(order);
+    }
+
+    return fft;
+}
+
+std::shared_ptr<const std::vector<float>> AnalysisService::getWindowTable(int size, juce::dsp::WindowingFunction<float>::WindowingMethod method)
+{
+    const juce::ScopedLock sl(resourcesLock);
+
+    auto& table = windowTables[{ size, (int)method }];
+    if (table == nullptr) {
+        auto newTable = std::make_shared<std::vector<float>>((size_t)size, 0.f);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(newTable->data(), (size_t)size, method);
+        table = newTable;
+    }
+
+    return table;
+}
+
+void AnalysisService::hiResTimerCallback()
+{
+    const juce::ScopedLock sl(clientsLock);
+
+    currentPhase = (currentPhase + 1) % numPhases;
+
+    for (auto* job : jobs) {
+        // A client that is still busy from its last slot just skips this one.
+        if (job->phase == currentPhase && !pool.contains(job)) {
+            pool.addJob(job, false);
+        }
+    }
+}
+
+void AnalysisService::timerCallback()
+{
+    const juce::ScopedLock sl(clientsLock);
+
+    for (auto* job : jobs) {
+        job->client.handleAnalysisResults();
+    }
+}
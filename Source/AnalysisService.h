@@ -0,0 +1,70 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+
+// Process-wide home for spectrum analysis, shared by every editor through juce::SharedResourcePointer.
+// One high-resolution tick hands registered clients to a small thread pool, each client in its own
+// phase slot so their frames are spread across the frame interval instead of all landing at once.
+// One message-thread timer then lets every client pick up its results. FFT plans and window tables
+// are immutable once built and are shared between all clients asking for the same size.
+struct AnalysisService : private juce::HighResolutionTimer, private juce::Timer
+{
+    public:
+        struct Client
+        {
+            virtual ~Client() = default;
+
+            // Called on a pool thread, never concurrently with itself.
+            virtual void runAnalysis() = 0;
+
+            // Called on the message thread once per frame interval.
+            virtual void handleAnalysisResults() = 0;
+        };
+
+        AnalysisService();
+        ~AnalysisService() override;
+
+        void registerClient(Client& client);
+        void unregisterClient(Client& client);
+
+        std::shared_ptr<const juce::dsp::FFT> getFFT(int order);
+        std::shared_ptr<const std::vector<float>> getWindowTable(int size, juce::dsp::WindowingFunction<float>::WindowingMethod method);
+
+        static constexpr int frameIntervalMs = 60;
+
+    private:
+        static constexpr int tickIntervalMs = 10;
+        static constexpr int numPhases = frameIntervalMs / tickIntervalMs;
+        static constexpr int numThreads = 2;
+
+        struct ClientJob : juce::ThreadPoolJob
+        {
+            ClientJob(Client& c, int p) : juce::ThreadPoolJob("Spectrum analysis"), client(c), phase(p) {}
+
+            JobStatus runJob() override
+            {
+                client.runAnalysis();
+                return jobHasFinished;
+            }
+
+            Client& client;
+            const int phase;
+        };
+
+        juce::ThreadPool pool { numThreads };
+
+        juce::CriticalSection clientsLock;
+        juce::OwnedArray<ClientJob> jobs;
+        std::array<int, numPhases> clientsPerPhase {};
+        int currentPhase = 0;
+
+        juce::CriticalSection resourcesLock;
+        std::map<int, std::shared_ptr<const juce::dsp::FFT>> ffts;
+        std::map<std::pair<int, int>, std::shared_ptr<const std::vector<float>>> windowTables;
+
+        void hiResTimerCallback() override;
+        void timerCallback() override;
+
+        JUCE_DECLARE_NON_COPYABLE(AnalysisService)
+};
@@ -0,0 +1,84 @@
+#include "AnalyzerGovernor.h"
+
+namespace
+{
+    const std::array<AnalyzerGovernor::Level, AnalyzerGovernor::numLevels> levels
+    {{
+        { "Lowest",  11, 1, 4 },
+        { "Low",     11, 1, 2 },
+        { "Normal",  11, 2, 1 },
+        { "High",    12, 2, 1 },
+        { "Highest", 13, 4, 1 },
+    }};
+}
+
+const AnalyzerGovernor::Level& AnalyzerGovernor::getLevel(int index)
+{
+    return levels[(size_t)juce::jlimit(0, numLevels - 1, index)];
+}
+
+bool AnalyzerGovernor::setFloor(int newFloor)
+{
+    floor = juce::jlimit(0, numLevels - 1, newFloor);
+    ceiling = juce::jmax(ceiling, floor);
+
+    return moveTo(level);
+}
+
+bool AnalyzerGovernor::setCeiling(int newCeiling)
+{
+    ceiling = juce::jlimit(0, numLevels - 1, newCeiling);
+    floor = juce::jmin(floor, ceiling);
+
+    // A raised ceiling is reached through the usual headroom steps.
+    return moveTo(level);
+}
+
+bool AnalyzerGovernor::update(double editorSeconds, double intervalSeconds, float audioLoad)
+{
+    if (intervalSeconds <= 0) {
+        return false;
+    }
+
+    editorLoad += 0.3 * (editorSeconds / intervalSeconds - editorLoad);
+
+    auto underPressure = editorLoad > maxEditorLoad || audioLoad > maxAudioLoad;
+    auto hasHeadroom = editorLoad < maxEditorLoad * 0.3 && audioLoad < maxAudioLoad * 0.6f;
+
+    pressureFrames = underPressure ? pressureFrames + 1 : 0;
+    headroomFrames = hasHeadroom ? headroomFrames + 1 : 0;
+    ++framesAtLevel;
+
+    if (pressureFrames >= stepDownFrames && level > floor) {
+        // Pressure soon after a step up means that level can't be held, so the next attempt waits
+        // longer; pressure from outside after a long stable stretch starts the back-off over.
+        backOff = steppedUp && framesAtLevel < stepUpFrames ? juce::jmin(backOff * 2, maxBackOff) : 1;
+        steppedUp = false;
+
+        return moveTo(level - 1);
+    }
+
+    if (headroomFrames >= stepUpFrames * backOff && level < ceiling) {
+        steppedUp = true;
+
+        return moveTo(level + 1);
+    }
+
+    return false;
+}
+
+bool AnalyzerGovernor::moveTo(int newLevel)
+{
+    newLevel = juce::jlimit(floor, ceiling, newLevel);
+
+    pressureFrames = 0;
+    headroomFrames = 0;
+
+    if (newLevel == level) {
+        return false;
+    }
+
+    level = newLevel;
+    framesAtLevel = 0;
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+// Trades analyzer detail for CPU time. Once per analysis frame it is told how long the editor
+// spent analysing and painting and how loaded the audio thread is; under pressure it steps the
+// quality level down straight away, and after a stretch of headroom it steps back up. Each
+// level sets the FFT order, the frame overlap and how many analysis slots are skipped.
+// The level never leaves the user's floor..ceiling range, and a step up that runs straight back
+// into pressure doubles the wait before the next attempt.
+struct AnalyzerGovernor
+{
+    public:
+        struct Level
+        {
+            const char* name;
+            int fftOrder;
+            int overlap;        // FFT frames per FFT length of audio
+            int frameDivisor;   // analyse on every n-th slot
+        };
+
+        static constexpr int numLevels = 5;
+        static constexpr int defaultLevel = 2;
+
+        static const Level& getLevel(int index);
+
+        int getCurrentLevel() const { return level; }
+        int getFloor() const { return floor; }
+        int getCeiling() const { return ceiling; }
+
+        // Both return true when the current level had to move.
+        bool setFloor(int newFloor);
+        bool setCeiling(int newCeiling);
+
+        // Message thread, once per analysis frame. Returns true when the level changed.
+        bool update(double editorSeconds, double intervalSeconds, float audioLoad);
+
+    private:
+        static constexpr double maxEditorLoad = 0.1;
+        static constexpr float maxAudioLoad = 0.7f;
+        static constexpr int stepDownFrames = 2;
+        static constexpr int stepUpFrames = 50;
+        static constexpr int maxBackOff = 8;
+
+        int level = defaultLevel;
+        int floor = 0, ceiling = defaultLevel;
+
+        double editorLoad = 0;
+        int pressureFrames = 0, headroomFrames = 0;
+        int framesAtLevel = 0;
+        int backOff = 1;
+        bool steppedUp = false;
+
+        bool moveTo(int newLevel);
+};
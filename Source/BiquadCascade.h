@@ -0,0 +1,86 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+// Scalar biquad cascade in transposed direct form II whose coefficients, state and inter-section
+// signal are all kept in FloatType, whatever type the samples arrive in. Sections take normalised
+// coefficients laid out as b0, b1, b2, a1, a2.
+// The sections live in storage handed over by bind() (see DSPStateArena), which must hold maxSections
+// of them; until then the cascade is empty.
+template<typename FloatType>
+struct BiquadCascade
+{
+    public:
+        static constexpr int maxSections = 9;
+
+        // Coefficients next to the state they update; padded to a power of two so a cache line
+        // holds whole sections.
+        struct alignas(8 * sizeof(FloatType)) Section
+        {
+            FloatType b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+            FloatType s1 = 0, s2 = 0;
+        };
+
+        void bind(Section* storage)
+        {
+            sections = storage;
+            numSections = 0;
+        }
+
+        int getNumSections() const { return numSections; }
+
+        void setNumSections(int newNumSections)
+        {
+            jassert(newNumSections >= 0 && newNumSections <= maxSections);
+            jassert(sections != nullptr || newNumSections == 0);
+            numSections = newNumSections;
+        }
+
+        void setSection(int index, const FloatType* biquad)
+        {
+            jassert(sections != nullptr && juce::isPositiveAndBelow(index, maxSections));
+
+            auto& section = sections[index];
+            section.b0 = biquad[0];
+            section.b1 = biquad[1];
+            section.b2 = biquad[2];
+            section.a1 = biquad[3];
+            section.a2 = biquad[4];
+        }
+
+        void reset()
+        {
+            if (sections == nullptr) {
+                return;
+            }
+
+            for (int s = 0; s < maxSections; ++s) {
+                sections[s].s1 = 0;
+                sections[s].s2 = 0;
+            }
+        }
+
+        template<typename SampleType>
+        void process(SampleType* data, int numSamples) noexcept
+        {
+            for (int i = 0; i < numSamples; ++i) {
+                auto x = static_cast<FloatType>(data[i]);
+
+                for (int s = 0; s < numSections; ++s) {
+                    auto& section = sections[s];
+
+                    auto y = section.b0 * x + section.s1;
+                    section.s1 = section.b1 * x - section.a1 * y + section.s2;
+                    section.s2 = section.b2 * x - section.a2 * y;
+                    x = y;
+                }
+
+                data[i] = static_cast<SampleType>(x);
+            }
+        }
+
+    private:
+        Section* sections = nullptr;
+        int numSections = 0;
+};
@@ -0,0 +1,152 @@
+#include "BlockParallelIIR.h"
+#include "PluginProcessor.h"
+
+#if JUCE_USE_SIMD
+
+void BlockParallelCascade::Section::design(const float* biquad)
+{
+    b0 = biquad[0];
+    b1 = biquad[1];
+    b2 = biquad[2];
+    a1 = biquad[3];
+    a2 = biquad[4];
+
+    // Transposed direct form II as a state-space system:
+    //     s[n+1] = A s[n] + B x[n],   y[n] = C s[n] + D x[n]
+    // with A = [-a1 1; -a2 0], B = [b1 - a1 b0; b2 - a2 b0], C = [1 0], D = b0.
+    const double A[2][2] = { { -a1, 1.0 }, { -a2, 0.0 } };
+    const double B[2] = { b1 - (double)a1 * b0, b2 - (double)a2 * b0 };
+
+    // power = A^n, row 0 of which is C A^n; impulse[m] = C A^(m-1) B for m > 0.
+    double power[2][2] = { { 1.0, 0.0 }, { 0.0, 1.0 } };
+    double impulse[blockSize];
+    impulse[0] = b0;
+
+    alignas(Lanes) float observeLanes[2][blockSize];
+
+    for (int n = 0; n < blockSize; ++n) {
+        observeLanes[0][n] = (float)power[0][0];
+        observeLanes[1][n] = (float)power[0][1];
+
+        if (n + 1 < blockSize) {
+            impulse[n + 1] = power[0][0] * B[0] + power[0][1] * B[1];
+        }
+
+        double next[2][2];
+        for (int r = 0; r < 2; ++r) {
+            for (int c = 0; c < 2; ++c) {
+                next[r][c] = power[r][0] * A[0][c] + power[r][1] * A[1][c];
+            }
+        }
+
+        std::copy(&next[0][0], &next[0][0] + 4, &power[0][0]);
+    }
+
+    observe[0] = Lanes::fromRawArray(observeLanes[0]);
+    observe[1] = Lanes::fromRawArray(observeLanes[1]);
+
+    for (int k = 0; k < blockSize; ++k) {
+        alignas(Lanes) float column[blockSize];
+
+        for (int n = 0; n < blockSize; ++n) {
+            column[n] = n >= k ? (float)impulse[n - k] : 0.f;
+        }
+
+        toeplitz[k] = Lanes::fromRawArray(column);
+    }
+}
+
+void BlockParallelCascade::setCoefficients(const ChainCoefficients& chainCoefficients, bool withLowCut, bool withPeak, bool withHighCut)
+{
+    numSections = 0;
+
+    auto add = [this](const juce::dsp::IIR::Coefficients<float>& coefficients)
+        {
+            jassert(numSections < maxSections);
+
+            float biquad[5];
+            toBiquad(coefficients, biquad);
+            sections[(size_t)numSections++].design(biquad);
+        };
+
+    if (withLowCut) {
+        for (auto* section : chainCoefficients.lowCut) {
+            add(*section);
+        }
+    }
+
+    if (withPeak) {
+        add(*chainCoefficients.peak);
+    }
+
+    if (withHighCut) {
+        for (auto* section : chainCoefficients.highCut) {
+            add(*section);
+        }
+    }
+}
+
+void BlockParallelCascade::setSection(int index, const float* biquad)
+{
+    jassert(juce::isPositiveAndBelow(index, numSections));
+    sections[(size_t)index].design(biquad);
+}
+
+void BlockParallelCascade::reset()
+{
+    for (auto& section : sections) {
+        section.s1 = 0;
+        section.s2 = 0;
+    }
+}
+
+void BlockParallelCascade::process(float* data, int numSamples) noexcept
+{
+    alignas(Lanes) float x[blockSize];
+    alignas(Lanes) float y[blockSize];
+
+    int i = 0;
+
+    for (; i + blockSize <= numSamples; i += blockSize) {
+        std::copy(data + i, data + i + blockSize, x);
+
+        for (int s = 0; s < numSections; ++s) {
+            auto& section = sections[(size_t)s];
+
+            auto out = section.observe[0] * Lanes::expand(section.s1);
+            out = Lanes::multiplyAdd(out, section.observe[1], Lanes::expand(section.s2));
+
+            for (int k = 0; k < blockSize; ++k) {
+                out = Lanes::multiplyAdd(out, section.toeplitz[k], Lanes::expand(x[k]));
+            }
+
+            out.copyToRawArray(y);
+
+            const auto last = blockSize - 1;
+            section.s2 = section.b2 * x[last] - section.a2 * y[last];
+            section.s1 = section.b1 * x[last] - section.a1 * y[last] + section.b2 * x[last - 1] - section.a2 * y[last - 1];
+
+            std::copy(y, y + blockSize, x);
+        }
+
+        std::copy(x, x + blockSize, data + i);
+    }
+
+    // Leftover samples run through the plain transposed direct form II recursion with the same state.
+    for (; i < numSamples; ++i) {
+        auto sample = data[i];
+
+        for (int s = 0; s < numSections; ++s) {
+            auto& section = sections[(size_t)s];
+
+            auto out = section.b0 * sample + section.s1;
+            section.s1 = section.b1 * sample - section.a1 * out + section.s2;
+            section.s2 = section.b2 * sample - section.a2 * out;
+            sample = out;
+        }
+
+        data[i] = sample;
+    }
+}
+
+#endif
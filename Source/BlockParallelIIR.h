@@ -0,0 +1,46 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+struct ChainCoefficients;
+
+#if JUCE_USE_SIMD
+
+// Look-ahead (state-space) form of a biquad cascade that computes one SIMD register's worth of
+// consecutive samples per step. For a block of M samples each section's output is
+//     y = O * s + T * x
+// where O maps the two state values onto the block and T is the lower-triangular Toeplitz matrix
+// of the section's impulse response. The state carried into the next block is recovered from the
+// last two inputs and outputs, so no extra matrix is needed for it. The matrices only depend on the
+// coefficients and are rebuilt when a new ChainCoefficients set is applied.
+struct BlockParallelCascade
+{
+    public:
+        using Lanes = juce::dsp::SIMDRegister<float>;
+        static constexpr int blockSize = (int)Lanes::SIMDNumElements;
+        static constexpr int maxSections = 9;
+
+        void setCoefficients(const ChainCoefficients& chainCoefficients, bool withLowCut = true, bool withPeak = true, bool withHighCut = true);
+        void setSection(int index, const float* biquad);
+        void reset();
+
+        void process(float* data, int numSamples) noexcept;
+
+    private:
+        static_assert(blockSize >= 2, "The state update reads the last two samples of each block");
+
+        struct Section
+        {
+            Lanes observe[2];
+            Lanes toeplitz[blockSize];
+            float b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+            float s1 = 0, s2 = 0;
+
+            void design(const float* biquad);
+        };
+
+        std::array<Section, maxSections> sections;
+        int numSections = 0;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+
+// One cache-line-aligned block per processor instance holding the state the audio thread works
+// on. Users carve their slices in the order they are visited while processing, each slice starting
+// on a fresh cache line, so a block walks forward through a few contiguous lines instead of
+// chasing separate heap objects.
+struct DSPStateArena
+{
+    public:
+        static constexpr size_t cacheLineSize = 64;
+
+        static constexpr size_t getSliceSize(size_t numBytes)
+        {
+            return (numBytes + cacheLineSize - 1) & ~(cacheLineSize - 1);
+        }
+
+        // Drops the previous block, so everything carved from it has to be carved again.
+        void allocate(size_t numBytes)
+        {
+            storage.free();
+            storage.calloc(numBytes + cacheLineSize);
+
+            auto address = reinterpret_cast<std::uintptr_t>(storage.get());
+            base = storage.get() + (getSliceSize(address) - address);
+            capacity = numBytes;
+            used = 0;
+        }
+
+        template<typename Type>
+        Type* carve(size_t count)
+        {
+            static_assert(std::is_trivially_destructible_v<Type>, "Slices are never destroyed");
+            static_assert(alignof(Type) <= cacheLineSize, "Slices are only cache-line aligned");
+
+            jassert(used + count * sizeof(Type) <= capacity);
+
+            auto* slice = reinterpret_cast<Type*>(base + used);
+            std::uninitialized_default_construct_n(slice, count);
+            used += getSliceSize(count * sizeof(Type));
+
+            return slice;
+        }
+
+        size_t getSize() const { return capacity; }
+
+    private:
+        juce::HeapBlock<char> storage;
+        char* base = nullptr;
+        size_t capacity = 0, used = 0;
+};
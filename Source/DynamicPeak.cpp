@@ -0,0 +1,162 @@
+#include "DynamicPeak.h"
+#include "PluginProcessor.h"
+
+DynamicPeakSettings getDynamicPeakSettings(juce::AudioProcessorValueTreeState& apvts)
+{
+    DynamicPeakSettings settings;
+
+    settings.enabled = apvts.getRawParameterValue(PEAK_DYNAMIC_PARAM_NAME)->load() > 0.5f;
+    settings.useSidechain = apvts.getRawParameterValue(PEAK_SIDECHAIN_PARAM_NAME)->load() > 0.5f;
+    settings.thresholdInDecibels = apvts.getRawParameterValue(PEAK_THRESHOLD_PARAM_NAME)->load();
+    settings.rangeInDecibels = apvts.getRawParameterValue(PEAK_RANGE_PARAM_NAME)->load();
+
+    return settings;
+}
+
+void DynamicPeakDetector::prepare(double newSampleRate, int controlQuantum)
+{
+    sampleRate = newSampleRate;
+    quantum = juce::jmax(1, controlQuantum);
+
+    auto controlRate = sampleRate / quantum;
+    attack = (float)std::exp(-1.0 / (attackMs * 0.001 * controlRate));
+    release = (float)std::exp(-1.0 / (releaseMs * 0.001 * controlRate));
+
+    reset();
+}
+
+void DynamicPeakDetector::reset()
+{
+    s1 = s2 = 0;
+    runningPeak = 0;
+    envelope = 0;
+    gainOffset = 0;
+    numTicks = 0;
+}
+
+void DynamicPeakDetector::setBand(float frequency, float quality)
+{
+    // Constant 0 dB peak band-pass; b1 is always zero.
+    auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    auto alpha = std::sin(omega) / (2.0 * quality);
+    auto a0 = 1.0 + alpha;
+
+    b0 = (float)(alpha / a0);
+    b2 = (float)(-alpha / a0);
+    a1 = (float)(-2.0 * std::cos(omega) / a0);
+    a2 = (float)((1.0 - alpha) / a0);
+}
+
+void DynamicPeakDetector::analyse(const juce::AudioBuffer<float>& detection, int numSamples, int firstTick)
+{
+    analyseBlock(detection, numSamples, firstTick);
+}
+
+void DynamicPeakDetector::analyse(const juce::AudioBuffer<double>& detection, int numSamples, int firstTick)
+{
+    analyseBlock(detection, numSamples, firstTick);
+}
+
+template<typename SampleType>
+void DynamicPeakDetector::analyseBlock(const juce::AudioBuffer<SampleType>& detection, int numSamples, int firstTick)
+{
+    using FVO = juce::FloatVectorOperations;
+
+    auto numChannels = detection.getNumChannels();
+
+    firstTickPosition = firstTick;
+    numTicks = 0;
+
+    int nextTick = firstTick;
+    int position = 0;
+
+    while (true) {
+        // Close every quantum ending here; the level of a quantum split across blocks carries over.
+        while (nextTick <= position && nextTick < numSamples) {
+            if (numTicks < maxTicksPerBlock) {
+                tickPeaks[(size_t)numTicks++] = runningPeak;
+                runningPeak = 0;
+            }
+
+            nextTick += quantum;
+        }
+
+        if (position >= numSamples) {
+            break;
+        }
+
+        auto num = juce::jmin(scratchSize, numSamples - position, nextTick - position);
+        auto* x = scratch.data();
+
+        if (numChannels == 0) {
+            FVO::clear(x, num);
+        } else {
+            // The detector only needs float; double input is narrowed while it is summed.
+            for (int channel = 0; channel < numChannels; ++channel) {
+                auto* source = detection.getReadPointer(channel, position);
+
+                if constexpr (std::is_same_v<SampleType, float>) {
+                    if (channel == 0) {
+                        FVO::copy(x, source, num);
+                    } else {
+                        FVO::add(x, source, num);
+                    }
+                } else {
+                    for (int i = 0; i < num; ++i) {
+                        x[i] = channel == 0 ? (float)source[i] : x[i] + (float)source[i];
+                    }
+                }
+            }
+
+            FVO::multiply(x, 1.f / numChannels, num);
+        }
+
+        for (int i = 0; i < num; ++i) {
+            auto out = b0 * x[i] + s1;
+            s1 = s2 - a1 * out;
+            s2 = b2 * x[i] - a2 * out;
+            x[i] = out;
+        }
+
+        auto range = FVO::findMinAndMax(x, num);
+        runningPeak = juce::jmax(runningPeak, -range.getStart(), range.getEnd());
+
+        position += num;
+    }
+}
+
+bool DynamicPeakDetector::tick(int position, const DynamicPeakSettings& settings)
+{
+    float target = 0;
+
+    if (settings.enabled) {
+        auto index = (position - firstTickPosition) / quantum;
+
+        if (!juce::isPositiveAndBelow(index, numTicks)) {
+            return false;
+        }
+
+        auto peak = tickPeaks[(size_t)index];
+        auto coefficient = peak > envelope ? attack : release;
+        envelope = peak + coefficient * (envelope - peak);
+
+        auto overshoot = juce::Decibels::gainToDecibels(envelope, -100.f) - settings.thresholdInDecibels;
+
+        if (overshoot > 0) {
+            auto amount = juce::jmin(std::abs(settings.rangeInDecibels), overshoot * (1.f - 1.f / ratio));
+            target = std::copysign(amount, settings.rangeInDecibels);
+        }
+    } else {
+        envelope = 0;
+    }
+
+    // Small moves are held back so the band isn't redesigned on every tick; returning to the
+    // static gain is always exact.
+    auto changed = std::abs(target - gainOffset) >= updateStepInDecibels || (target == 0.f && gainOffset != 0.f);
+
+    if (changed) {
+        gainOffset = target;
+    }
+
+    return changed;
+}
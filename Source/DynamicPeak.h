@@ -0,0 +1,59 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+struct DynamicPeakSettings
+{
+    bool enabled { false }, useSidechain { false };
+    float thresholdInDecibels { -24.f }, rangeInDecibels { -6.f };
+};
+
+DynamicPeakSettings getDynamicPeakSettings(juce::AudioProcessorValueTreeState& apvts);
+
+// Level detector that drives the peak band's gain in dynamic mode.
+// The detection signal (the main input or the side-chain, summed to mono) runs through a band-pass
+// centred on the peak band, and its peak level is collected per control quantum before the block is
+// rendered. Each control tick then runs an attack/release follower and maps the level above the
+// threshold onto a gain offset, limited to the range. A tick only reports a new offset once it has
+// moved by more than a small step; the processor then ramps the band to it over the next quantum.
+struct DynamicPeakDetector
+{
+    public:
+        void prepare(double sampleRate, int controlQuantum);
+        void reset();
+        void setBand(float frequency, float quality);
+
+        void analyse(const juce::AudioBuffer<float>& detection, int numSamples, int firstTick);
+        void analyse(const juce::AudioBuffer<double>& detection, int numSamples, int firstTick);
+        bool tick(int position, const DynamicPeakSettings& settings);
+
+        float getGainOffsetInDecibels() const { return gainOffset; }
+
+    private:
+        static constexpr float attackMs = 5.f;
+        static constexpr float releaseMs = 80.f;
+        static constexpr float ratio = 2.f;
+        static constexpr float updateStepInDecibels = 0.1f;
+        static constexpr int scratchSize = 256;
+        static constexpr int maxTicksPerBlock = 1024;
+
+        double sampleRate = 44100;
+        int quantum = 32;
+
+        float b0 = 0, b2 = 0, a1 = 0, a2 = 0;
+        float s1 = 0, s2 = 0;
+
+        std::array<float, scratchSize> scratch;
+        std::array<float, maxTicksPerBlock> tickPeaks;
+        int firstTickPosition = 0;
+        int numTicks = 0;
+
+        float runningPeak = 0;
+        float envelope = 0;
+        float attack = 0, release = 0;
+        float gainOffset = 0;
+
+        template<typename SampleType>
+        void analyseBlock(const juce::AudioBuffer<SampleType>& detection, int numSamples, int firstTick);
+};
@@ -0,0 +1,172 @@
+#include "LevelMeter.h"
+
+namespace
+{
+    // Four independent sums, so the loop vectorises without reassociating one accumulator.
+    template<typename SampleType>
+    SampleType sumOfSquares(const SampleType* data, int numSamples)
+    {
+        SampleType sums[4] {};
+        int i = 0;
+
+        for (; i + 4 <= numSamples; i += 4) {
+            for (int k = 0; k < 4; ++k) {
+                sums[k] += data[i + k] * data[i + k];
+            }
+        }
+
+        for (; i < numSamples; ++i) {
+            sums[0] += data[i] * data[i];
+        }
+
+        return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    }
+}
+
+void LevelMeter::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    reset();
+}
+
+void LevelMeter::reset()
+{
+    for (int channel = 0; channel < maxChannels; ++channel) {
+        peakHold[(size_t)channel] = 0;
+        meanSquare[(size_t)channel] = 0;
+        peak[(size_t)channel].store(0);
+        rms[(size_t)channel].store(0);
+    }
+}
+
+void LevelMeter::measure(const juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    measureBlock(buffer, numSamples);
+}
+
+void LevelMeter::measure(const juce::AudioBuffer<double>& buffer, int numSamples)
+{
+    measureBlock(buffer, numSamples);
+}
+
+template<typename SampleType>
+void LevelMeter::measureBlock(const juce::AudioBuffer<SampleType>& buffer, int numSamples)
+{
+    if (numSamples <= 0) {
+        return;
+    }
+
+    const auto seconds = numSamples / sampleRate;
+    const auto peakFall = (float)juce::Decibels::decibelsToGain(-peakFallDecibelsPerSecond * seconds);
+    const auto rmsDecay = (float)std::exp(-seconds / rmsTimeSeconds);
+
+    for (int channel = 0; channel < juce::jmin(maxChannels, buffer.getNumChannels()); ++channel) {
+        auto* data = buffer.getReadPointer(channel);
+        auto range = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+
+        auto blockPeak = (float)juce::jmax(-range.getStart(), range.getEnd());
+        auto blockMeanSquare = (float)(sumOfSquares(data, numSamples) / numSamples);
+
+        auto& held = peakHold[(size_t)channel];
+        auto& integrated = meanSquare[(size_t)channel];
+
+        held = juce::jmax(blockPeak, held * peakFall);
+        integrated = blockMeanSquare + rmsDecay * (integrated - blockMeanSquare);
+
+        peak[(size_t)channel].store(held, std::memory_order_relaxed);
+        rms[(size_t)channel].store(std::sqrt(integrated), std::memory_order_relaxed);
+    }
+}
+
+void LoudnessMeter::prepare(double sampleRate)
+{
+    // The BS.1770 pre-filter (high shelf) and RLB high-pass, redesigned for this rate.
+    double shelf[5], highPass[5];
+
+    {
+        const auto K = std::tan(juce::MathConstants<double>::pi * 1681.974450955533 / sampleRate);
+        const auto Q = 0.7071752369554196;
+        const auto Vh = std::pow(10.0, 3.999843853973347 / 20.0);
+        const auto Vb = std::pow(Vh, 0.4996667741545416);
+        const auto a0 = 1.0 + K / Q + K * K;
+
+        shelf[0] = (Vh + Vb * K / Q + K * K) / a0;
+        shelf[1] = 2.0 * (K * K - Vh) / a0;
+        shelf[2] = (Vh - Vb * K / Q + K * K) / a0;
+        shelf[3] = 2.0 * (K * K - 1.0) / a0;
+        shelf[4] = (1.0 - K / Q + K * K) / a0;
+    }
+
+    {
+        const auto K = std::tan(juce::MathConstants<double>::pi * 38.13547087602444 / sampleRate);
+        const auto Q = 0.5003270373238773;
+        const auto a0 = 1.0 + K / Q + K * K;
+
+        highPass[0] = 1.0;
+        highPass[1] = -2.0;
+        highPass[2] = 1.0;
+        highPass[3] = 2.0 * (K * K - 1.0) / a0;
+        highPass[4] = (1.0 - K / Q + K * K) / a0;
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        auto& cascade = weighting[(size_t)channel];
+
+        cascade.bind(sections[(size_t)channel].data());
+        cascade.setNumSections(2);
+        cascade.setSection(0, shelf);
+        cascade.setSection(1, highPass);
+        cascade.reset();
+    }
+
+    blockLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+    blockPosition = 0;
+    blockIndex = 0;
+    numBlocksFilled = 0;
+    energy = 0;
+    blockEnergy.fill(0);
+
+    loudness.store(silence);
+}
+
+void LoudnessMeter::process(const juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    scratch.resize((size_t)numSamples);
+
+    for (int start = 0; start < numSamples;) {
+        auto num = juce::jmin(numSamples - start, blockLength - blockPosition);
+
+        // Left and right weigh 1 each.
+        for (int channel = 0; channel < numChannels; ++channel) {
+            auto* source = buffer.getReadPointer(juce::jmin(channel, buffer.getNumChannels() - 1), start);
+            std::copy(source, source + num, scratch.begin());
+
+            weighting[(size_t)channel].process(scratch.data(), num);
+            energy += sumOfSquares(scratch.data(), num);
+        }
+
+        start += num;
+        blockPosition += num;
+
+        if (blockPosition < blockLength) {
+            break;
+        }
+
+        blockEnergy[(size_t)blockIndex] = energy;
+        blockIndex = (blockIndex + 1) % numBlocks;
+        numBlocksFilled = juce::jmin(numBlocks, numBlocksFilled + 1);
+        blockPosition = 0;
+        energy = 0;
+
+        double total = 0;
+
+        for (int i = 0; i < numBlocksFilled; ++i) {
+            total += blockEnergy[(size_t)i];
+        }
+
+        auto meanSquare = total / (double(numBlocksFilled) * blockLength);
+        auto lufs = meanSquare > 0 ? -0.691 + 10.0 * std::log10(meanSquare) : (double)silence;
+
+        loudness.store((float)juce::jmax((double)silence, lufs), std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "BiquadCascade.h"
+
+// Per-channel peak and RMS of one tap, measured on the audio thread with a couple of block
+// reductions per channel and published as atomics once per block. The peak falls back at a fixed
+// rate and the RMS integrates over a few hundred milliseconds, both per block, so a reader polling
+// at any rate sees every peak.
+struct LevelMeter
+{
+    public:
+        static constexpr int maxChannels = 2;
+
+        void prepare(double sampleRate);
+        void reset();
+
+        void measure(const juce::AudioBuffer<float>& buffer, int numSamples);
+        void measure(const juce::AudioBuffer<double>& buffer, int numSamples);
+
+        // Linear gains, any thread.
+        float getPeak(int channel) const { return peak[(size_t)channel].load(std::memory_order_relaxed); }
+        float getRMS(int channel) const { return rms[(size_t)channel].load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr double peakFallDecibelsPerSecond = 20.0;
+        static constexpr double rmsTimeSeconds = 0.3;
+
+        double sampleRate = 44100;
+        std::array<float, maxChannels> peakHold {}, meanSquare {};
+        std::array<std::atomic<float>, maxChannels> peak {}, rms {};
+
+        template<typename SampleType>
+        void measureBlock(const juce::AudioBuffer<SampleType>& buffer, int numSamples);
+};
+
+// Short-term loudness (ITU-R BS.1770 K-weighting, 3 s window) of a stereo signal. The K-weighting
+// filters every sample, which on the audio thread would cost a sizeable share of the EQ itself, so
+// this runs on the analysis thread over a BroadcastRing feed.
+struct LoudnessMeter
+{
+    public:
+        void prepare(double sampleRate);
+        void process(const juce::AudioBuffer<float>& buffer, int numSamples);
+
+        // LUFS, any thread.
+        float getShortTermLoudness() const { return loudness.load(std::memory_order_relaxed); }
+
+        static constexpr float silence = -100.f;
+
+    private:
+        static constexpr int numBlocks = 30;    // 100 ms each
+        static constexpr int numChannels = 2;
+
+        std::array<std::array<BiquadCascade<double>::Section, BiquadCascade<double>::maxSections>, numChannels> sections;
+        std::array<BiquadCascade<double>, numChannels> weighting;
+        std::vector<float> scratch;
+
+        std::array<double, numBlocks> blockEnergy {};
+        int blockLength = 4410;
+        int blockPosition = 0;
+        int blockIndex = 0;
+        int numBlocksFilled = 0;
+        double energy = 0;
+
+        std::atomic<float> loudness { silence };
+};
@@ -0,0 +1,158 @@
+#include "LevelMeterComponent.h"
+#include "PluginEditor.h"
+
+LevelMeterComponent::LevelMeterComponent(SimpleEQAudioProcessor& p) :
+audioProcessor(p)
+{
+}
+
+LevelMeterComponent::~LevelMeterComponent()
+{
+    if (meteringStarted) {
+        analysisService->unregisterClient(*this);
+    }
+}
+
+void LevelMeterComponent::startMetering()
+{
+    if (meteringStarted) {
+        return;
+    }
+
+    inputFeed.reader = audioProcessor.inputFeed.createReader();
+    outputFeed.reader = audioProcessor.analyzerFeed.createReader();
+
+    meteringStarted = true;
+    analysisService->registerClient(*this);
+}
+
+void LevelMeterComponent::runAnalysis()
+{
+    auto sampleRate = audioProcessor.getSampleRate();
+
+    if (sampleRate <= 0) {
+        return;
+    }
+
+    if (sampleRate != loudnessSampleRate) {
+        loudnessSampleRate = sampleRate;
+        inputFeed.loudness.prepare(sampleRate);
+        outputFeed.loudness.prepare(sampleRate);
+    }
+
+    pullFeed(audioProcessor.inputFeed, inputFeed);
+    pullFeed(audioProcessor.analyzerFeed, outputFeed);
+}
+
+void LevelMeterComponent::pullFeed(BroadcastRing<float>& ring, Feed& feed)
+{
+    auto now = juce::Time::getMillisecondCounter();
+    auto anyRead = false;
+
+    // Reads fail while no view holds the feed; nothing is pushed then, so the reader just waits.
+    while (ring.getNumAvailable(feed.reader) >= chunkSize && ring.read(feed.reader, chunk, chunkSize)) {
+        feed.loudness.process(chunk, chunkSize);
+        anyRead = true;
+    }
+
+    if (anyRead) {
+        feed.lastReadTime = now;
+        feed.measuring.store(true);
+    } else if (feed.measuring.load() && now - feed.lastReadTime > feedTimeoutMs) {
+        // The view holding the feed has gone; start from silence when it comes back.
+        feed.measuring.store(false);
+        feed.loudness.prepare(loudnessSampleRate);
+    }
+}
+
+LevelMeterComponent::Tap LevelMeterComponent::readTap(const LevelMeter& meter, const Feed& feed)
+{
+    Tap tap;
+
+    for (int channel = 0; channel < LevelMeter::maxChannels; ++channel) {
+        tap.peak[(size_t)channel] = juce::Decibels::gainToDecibels(meter.getPeak(channel), minDecibels);
+        tap.rms[(size_t)channel] = juce::Decibels::gainToDecibels(meter.getRMS(channel), minDecibels);
+    }
+
+    tap.loudness = feed.loudness.getShortTermLoudness();
+    tap.measured = feed.measuring.load();
+
+    return tap;
+}
+
+void LevelMeterComponent::handleAnalysisResults()
+{
+    auto newInput = readTap(audioProcessor.getInputMeter(), inputFeed);
+    auto newOutput = readTap(audioProcessor.getOutputMeter(), outputFeed);
+
+    auto changed = [](const Tap& a, const Tap& b)
+        {
+            return a.peak != b.peak || a.rms != b.rms || a.measured != b.measured
+                || std::abs(a.loudness - b.loudness) >= 0.1f;
+        };
+
+    if (changed(newInput, input) || changed(newOutput, output)) {
+        input = newInput;
+        output = newOutput;
+        repaint();
+    }
+}
+
+void LevelMeterComponent::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().reduced(4);
+
+    drawTap(g, bounds.removeFromLeft(bounds.getWidth() / 2), "IN", input);
+    drawTap(g, bounds, "OUT", output);
+
+    // Metering starts once the first frame is on screen, as the analyzer does.
+    if (!meteringStarted && !meteringStartPending) {
+        meteringStartPending = true;
+
+        juce::Component::SafePointer<LevelMeterComponent> safeThis(this);
+        juce::MessageManager::callAsync([safeThis]
+            {
+                if (safeThis != nullptr) safeThis->startMetering();
+            });
+    }
+}
+
+void LevelMeterComponent::drawTap(juce::Graphics& g, juce::Rectangle<int> area, const juce::String& name, const Tap& tap)
+{
+    g.setFont(10);
+    g.setColour(SLIDER_FONT_COLOR);
+    g.drawFittedText(name, area.removeFromTop(12), juce::Justification::centred, 1);
+
+    auto loudness = !tap.measured ? juce::String("--")
+                  : tap.loudness < -70.f ? juce::String("-inf")
+                  : juce::String(tap.loudness, 1);
+    g.drawFittedText(loudness, area.removeFromBottom(12), juce::Justification::centred, 1);
+
+    area = area.reduced(4, 2);
+    auto barWidth = area.getWidth() / LevelMeter::maxChannels;
+
+    auto toY = [&area](float decibels)
+        {
+            return juce::jmap(juce::jlimit(minDecibels, maxDecibels, decibels), minDecibels, maxDecibels,
+                              (float)area.getBottom(), (float)area.getY());
+        };
+
+    for (int channel = 0; channel < LevelMeter::maxChannels; ++channel) {
+        auto bar = area.withX(area.getX() + channel * barWidth).withWidth(barWidth).reduced(1, 0).toFloat();
+
+        g.setColour(juce::Colours::black);
+        g.fillRect(bar);
+
+        g.setColour(SLIDER_FILL_COLOR);
+        g.fillRect(bar.withTop(toY(tap.rms[(size_t)channel])));
+
+        if (tap.peak[(size_t)channel] > minDecibels) {
+            g.setColour(SLIDER_BORDER_COLOR);
+            g.fillRect(bar.withTop(toY(tap.peak[(size_t)channel])).withHeight(2.f));
+        }
+    }
+
+    // 0dBFS
+    g.setColour(juce::Colours::dimgrey);
+    g.drawHorizontalLine(juce::roundToInt(toY(0.f)), (float)area.getX(), (float)area.getRight());
+}
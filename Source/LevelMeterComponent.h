@@ -0,0 +1,59 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "AnalysisService.h"
+
+// Input and output meters: peak and RMS bars per channel from the processor's LevelMeters, and
+// short-term loudness worked out on an analysis thread from the input and output feeds. The feeds
+// are followed without being attached, so a loudness reading only runs while the view that holds
+// its feed does (the pre/post analyzer for the input, the analyzer for the output) and reads "--"
+// otherwise.
+struct LevelMeterComponent : juce::Component, AnalysisService::Client
+{
+    public:
+        LevelMeterComponent(SimpleEQAudioProcessor&);
+        ~LevelMeterComponent() override;
+
+        void runAnalysis() override;
+        void handleAnalysisResults() override;
+
+        void paint(juce::Graphics& g) override;
+
+    private:
+        struct Tap
+        {
+            std::array<float, LevelMeter::maxChannels> peak {}, rms {};
+            float loudness = LoudnessMeter::silence;
+            bool measured = false;
+        };
+
+        struct Feed
+        {
+            BroadcastRing<float>::Reader reader;
+            LoudnessMeter loudness;
+            juce::uint32 lastReadTime = 0;
+            std::atomic<bool> measuring { false };
+        };
+
+        static constexpr float minDecibels = -60.f, maxDecibels = 6.f;
+        static constexpr int chunkSize = 512;
+        static constexpr juce::uint32 feedTimeoutMs = 500;
+
+        SimpleEQAudioProcessor& audioProcessor;
+        juce::SharedResourcePointer<AnalysisService> analysisService;
+        bool meteringStarted = false, meteringStartPending = false;
+
+        juce::AudioBuffer<float> chunk { 2, chunkSize };
+        Feed inputFeed, outputFeed;
+        double loudnessSampleRate = 0;
+
+        Tap input, output;
+
+        void startMetering();
+        void pullFeed(BroadcastRing<float>& ring, Feed& feed);
+        static Tap readTap(const LevelMeter& meter, const Feed& feed);
+        void drawTap(juce::Graphics& g, juce::Rectangle<int> area, const juce::String& name, const Tap& tap);
+
+        JUCE_DECLARE_NON_COPYABLE(LevelMeterComponent)
+};
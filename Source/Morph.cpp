@@ -0,0 +1,112 @@
+#include "Morph.h"
+#include "PluginProcessor.h"
+
+namespace
+{
+    const char* const endpointPrefixes[] = { "Morph A:", "Morph B:" };
+}
+
+ChainSettings interpolateChainSettings(const ChainSettings& a, const ChainSettings& b, float amount)
+{
+    auto logLerp = [amount](float from, float to) { return from * std::pow(to / from, amount); };
+
+    auto settings = amount < 0.5f ? a : b;
+
+    settings.lowCutFreq = logLerp(a.lowCutFreq, b.lowCutFreq);
+    settings.highCutFreq = logLerp(a.highCutFreq, b.highCutFreq);
+    settings.peakFreq = logLerp(a.peakFreq, b.peakFreq);
+    settings.peakQuality = logLerp(a.peakQuality, b.peakQuality);
+    settings.peakGainInDecibels = a.peakGainInDecibels + amount * (b.peakGainInDecibels - a.peakGainInDecibels);
+
+    return settings;
+}
+
+void writeMorphEndpoint(Preset& preset, int slot, const ChainSettings& settings)
+{
+    juce::String prefix(endpointPrefixes[slot]);
+
+    preset.values.push_back({ prefix + LOW_CUT_FREQ_PARAM_NAME, settings.lowCutFreq });
+    preset.values.push_back({ prefix + HIGH_CUT_FREQ_PARAM_NAME, settings.highCutFreq });
+    preset.values.push_back({ prefix + PEAK_FREQ_PARAM_NAME, settings.peakFreq });
+    preset.values.push_back({ prefix + PEAK_GAIN_PARAM_NAME, settings.peakGainInDecibels });
+    preset.values.push_back({ prefix + PEAK_QUALITY_PARAM_NAME, settings.peakQuality });
+    preset.values.push_back({ prefix + LOW_CUT_SLOPE_PARAM_NAME, (float)settings.lowCutSlope });
+    preset.values.push_back({ prefix + HIGH_CUT_SLOPE_PARAM_NAME, (float)settings.highCutSlope });
+}
+
+ChainSettings readMorphEndpoint(const Preset& preset, int slot, const ChainSettings& fallback)
+{
+    juce::String prefix(endpointPrefixes[slot]);
+
+    auto read = [&](const char* name, float value)
+        {
+            auto* stored = preset.find(prefix + name);
+            return stored != nullptr ? stored->value : value;
+        };
+
+    auto readSlope = [&](const char* name, Slope value)
+        {
+            return static_cast<Slope>(juce::jlimit(0, 3, juce::roundToInt(read(name, (float)value))));
+        };
+
+    ChainSettings settings;
+
+    settings.lowCutFreq = read(LOW_CUT_FREQ_PARAM_NAME, fallback.lowCutFreq);
+    settings.highCutFreq = read(HIGH_CUT_FREQ_PARAM_NAME, fallback.highCutFreq);
+    settings.peakFreq = read(PEAK_FREQ_PARAM_NAME, fallback.peakFreq);
+    settings.peakGainInDecibels = read(PEAK_GAIN_PARAM_NAME, fallback.peakGainInDecibels);
+    settings.peakQuality = read(PEAK_QUALITY_PARAM_NAME, fallback.peakQuality);
+    settings.lowCutSlope = readSlope(LOW_CUT_SLOPE_PARAM_NAME, fallback.lowCutSlope);
+    settings.highCutSlope = readSlope(HIGH_CUT_SLOPE_PARAM_NAME, fallback.highCutSlope);
+
+    return settings;
+}
+
+void MorphEngine::swapEndpoints(EndpointPtr (&replacement)[2])
+{
+    std::swap(endpoints[0], replacement[0]);
+    std::swap(endpoints[1], replacement[1]);
+
+    loaded = nullptr;
+
+    if (hasEndpoints()) {
+        const auto& a = endpoints[0]->settings;
+        const auto& b = endpoints[1]->settings;
+
+        lowCutVaries = a.lowCutFreq != b.lowCutFreq;
+        highCutVaries = a.highCutFreq != b.highCutFreq;
+        peakVaries = a.peakFreq != b.peakFreq || a.peakQuality != b.peakQuality || a.peakGainInDecibels != b.peakGainInDecibels;
+    }
+}
+
+ChainSettings MorphEngine::apply(FilterEngine& engine, float amount, bool reload)
+{
+    jassert(hasEndpoints());
+
+    const auto& a = *endpoints[0];
+    const auto& b = *endpoints[1];
+    const auto& nearest = amount < 0.5f ? a : b;
+
+    auto settings = interpolateChainSettings(a.settings, b.settings, amount);
+
+    if (reload || loaded != &nearest) {
+        engine.setCoefficients(nearest);
+        loaded = &nearest;
+    }
+
+    auto sampleRate = nearest.sampleRate;
+
+    if (lowCutVaries) {
+        engine.setCutSections(ChainPositions::LowCut, settings, sampleRate);
+    }
+
+    if (peakVaries) {
+        engine.setPeak(settings, sampleRate, settings.peakGainInDecibels);
+    }
+
+    if (highCutVaries) {
+        engine.setCutSections(ChainPositions::HighCut, settings, sampleRate);
+    }
+
+    return settings;
+}
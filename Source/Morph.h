@@ -0,0 +1,34 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+struct ChainSettings;
+struct ChainCoefficients;
+struct FilterEngine;
+struct Preset;
+
+// Settings between the A (amount 0) and B (amount 1) endpoints. Frequencies and Q move on a log
+// scale and gain in dB; the cut slopes can't be blended and switch over half way.
+ChainSettings interpolateChainSettings(const ChainSettings& a, const ChainSettings& b, float amount);
+
+void writeMorphEndpoint(Preset& preset, int slot, const ChainSettings& settings);
+ChainSettings readMorphEndpoint(const Preset& preset, int slot, const ChainSettings& fallback);
+
+// Applies interpolated settings to a FilterEngine at control rate without allocating.
+// The designs of both endpoints are cached; the nearer one is loaded whole when the filter
+// structure changes, and only the bands that differ between A and B are redesigned in place.
+struct MorphEngine
+{
+    public:
+        using EndpointPtr = juce::ReferenceCountedObjectPtr<ChainCoefficients>;
+
+        void swapEndpoints(EndpointPtr (&replacement)[2]);
+        bool hasEndpoints() const { return endpoints[0] != nullptr && endpoints[1] != nullptr; }
+
+        ChainSettings apply(FilterEngine& engine, float amount, bool reload);
+
+    private:
+        EndpointPtr endpoints[2];
+        const ChainCoefficients* loaded = nullptr;
+        bool lowCutVaries = false, peakVaries = false, highCutVaries = false;
+};
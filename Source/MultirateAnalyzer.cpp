@@ -0,0 +1,198 @@
+#include "MultirateAnalyzer.h"
+
+namespace
+{
+    // 23 taps keeps the transition band inside 0.125..0.375 of the input rate, which is all
+    // the analyzer needs: it only reads the octave below a quarter of each decimated rate.
+    constexpr int halfBandLength = 23;
+    constexpr double lowestFrequency = 20.0;
+    constexpr int maxStages = 12;
+
+    std::vector<float> designHalfBandTaps()
+    {
+        static_assert(halfBandLength % 4 == 3, "Half-band zeros must land on the odd taps");
+
+        std::vector<float> taps(halfBandLength, 0.f);
+        const int centre = (halfBandLength - 1) / 2;
+        double sum = 0;
+
+        for (int k = 0; k < halfBandLength; ++k) {
+            auto offset = double(k - centre);
+            auto sinc = offset == 0 ? 1.0 : std::sin(juce::MathConstants<double>::halfPi * offset) / (juce::MathConstants<double>::halfPi * offset);
+            auto blackman = 0.42 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * k / (halfBandLength - 1))
+                                 + 0.08 * std::cos(2.0 * juce::MathConstants<double>::twoPi * k / (halfBandLength - 1));
+
+            taps[(size_t)k] = float(0.5 * sinc * blackman);
+            sum += taps[(size_t)k];
+        }
+
+        for (auto& tap : taps) {
+            tap = float(tap / sum);
+        }
+
+        return taps;
+    }
+}
+
+void MultirateSpectrumAnalyzer::HalfBandDecimator::prepare(const std::vector<float>& taps)
+{
+    coefficients = &taps;
+    history.assign(taps.size() * 2, 0.f);
+    writeIndex = 0;
+    skipNext = false;
+}
+
+bool MultirateSpectrumAnalyzer::HalfBandDecimator::process(float input, float& output)
+{
+    const auto length = (int)coefficients->size();
+
+    // Mirrored history so the newest `length` samples are always contiguous.
+    history[(size_t)writeIndex] = input;
+    history[(size_t)(writeIndex + length)] = input;
+    writeIndex = (writeIndex + 1) % length;
+
+    skipNext = !skipNext;
+    if (!skipNext) {
+        return false;
+    }
+
+    const auto* x = history.data() + writeIndex;
+    const auto* h = coefficients->data();
+    const int centre = (length - 1) / 2;
+
+    // Every other tap of a half-band filter is zero; only the even taps and the centre contribute.
+    float y = h[centre] * x[centre];
+    for (int k = 0; k < length; k += 2) {
+        y += h[k] * x[k];
+    }
+
+    output = y;
+    return true;
+}
+
+void MultirateSpectrumAnalyzer::prepare(AnalysisService& analysisService, double sampleRate, int numDisplayPoints, float negativeInfinity, int fftOrder)
+{
+    stages.clear();
+    displayPoints.clear();
+
+    if (sampleRate <= 0 || numDisplayPoints < 2) {
+        return;
+    }
+
+    fftSize = 1 << fftOrder;
+    hopSize = fftSize / 4;
+    forwardFFT = analysisService.getFFT(fftOrder);
+    windowTable = analysisService.getWindowTable(fftSize, juce::dsp::WindowingFunction<float>::hann);
+
+    fftBuffer.assign((size_t)fftSize * 2, 0.f);
+    halfBandTaps = designHalfBandTaps();
+
+    auto rate = sampleRate;
+    for (;;) {
+        auto& stage = stages.emplace_back();
+
+        stage.sampleRate = rate;
+        stage.decimator.prepare(halfBandTaps);
+        stage.ring.assign((size_t)fftSize, 0.f);
+        stage.magnitudes.assign((size_t)fftSize / 2, 0.f);
+
+        if (rate / 8.0 <= lowestFrequency || (int)stages.size() == maxStages) {
+            break;
+        }
+
+        rate *= 0.5;
+    }
+
+    // Stage 0 covers everything above fs/8; each later stage covers [rate/8, rate/4),
+    // where its bins are densest relative to the frequency and its decimator is flat.
+    for (int i = 0; i < numDisplayPoints; ++i) {
+        DisplayPoint point;
+        point.frequency = juce::mapToLog10(float(i) / float(numDisplayPoints - 1), 20.f, 20000.f);
+
+        point.stage = 0;
+        while (point.stage + 1 < (int)stages.size() && point.frequency < stages[(size_t)point.stage].sampleRate / 8.0) {
+            ++point.stage;
+        }
+
+        auto binWidth = stages[(size_t)point.stage].sampleRate / fftSize;
+        point.bin = juce::jlimit(0.f, float(fftSize / 2 - 1), float(point.frequency / binWidth));
+
+        displayPoints.push_back(point);
+    }
+
+    std::vector<float> pointFrequencies;
+    for (const auto& point : displayPoints) {
+        pointFrequencies.push_back(point.frequency);
+    }
+
+    // Frames come out once per stage-0 hop at most; the editor refines this from the block size it sees.
+    smoother.prepare(pointFrequencies, float(sampleRate / hopSize), negativeInfinity);
+
+    fftData.assign((size_t)numDisplayPoints * 2, 0.f);
+    fftDataFifo.prepare(fftData.size());
+}
+
+void MultirateSpectrumAnalyzer::pushSamples(const float* samples, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i) {
+        auto sample = samples[i];
+
+        for (size_t s = 0; s < stages.size(); ++s) {
+            auto& stage = stages[s];
+
+            stage.ring[(size_t)stage.ringIndex] = sample;
+            stage.ringIndex = (stage.ringIndex + 1) % fftSize;
+
+            if (++stage.samplesSinceLastFrame >= hopSize) {
+                stage.samplesSinceLastFrame = 0;
+                analyzeStage(stage);
+            }
+
+            if (s + 1 == stages.size() || !stage.decimator.process(sample, sample)) {
+                break;
+            }
+        }
+    }
+}
+
+void MultirateSpectrumAnalyzer::analyzeStage(Stage& stage)
+{
+    TraceScope trace("FFT constant-Q stage");
+
+    const auto oldest = (size_t)stage.ringIndex;
+    const auto tail = (size_t)fftSize - oldest;
+
+    std::copy(stage.ring.begin() + (std::ptrdiff_t)oldest, stage.ring.end(), fftBuffer.begin());
+    std::copy(stage.ring.begin(), stage.ring.begin() + (std::ptrdiff_t)oldest, fftBuffer.begin() + (std::ptrdiff_t)tail);
+    std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.f);
+
+    juce::FloatVectorOperations::multiply(fftBuffer.data(), windowTable->data(), fftSize);
+    forwardFFT->performFrequencyOnlyForwardTransform(fftBuffer.data());
+
+    juce::FloatVectorOperations::multiply(stage.magnitudes.data(), fftBuffer.data(), 1.f / float(fftSize / 2), fftSize / 2);
+}
+
+void MultirateSpectrumAnalyzer::produceFFTDataForRendering(const float negativeInfinity)
+{
+    if (stages.empty()) {
+        return;
+    }
+
+    const auto numPoints = displayPoints.size();
+
+    for (size_t i = 0; i < numPoints; ++i) {
+        const auto& point = displayPoints[i];
+        const auto& magnitudes = stages[(size_t)point.stage].magnitudes;
+
+        auto lower = (size_t)point.bin;
+        auto upper = juce::jmin(lower + 1, magnitudes.size() - 1);
+        auto fraction = point.bin - float(lower);
+
+        auto magnitude = magnitudes[lower] + (magnitudes[upper] - magnitudes[lower]) * fraction;
+        fftData[i] = juce::Decibels::gainToDecibels(magnitude, negativeInfinity);
+    }
+
+    smoother.process(fftData.data(), fftData.data() + numPoints, (int)numPoints);
+
+    fftDataFifo.push(fftData);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "SpectrumSmoother.h"
+#include "AnalysisService.h"
+
+// Roughly constant-Q spectrum analysis built from a cascade of half-band decimators.
+// Stage 0 runs at the host rate and every following stage at half the rate of the previous one,
+// each with the same small FFT. Every stage only contributes the octave where its bins are dense
+// and its decimation filter is flat, so low frequencies get long windows without a huge FFT.
+// Each frame holds the smoothed display points followed by their peak-hold trace.
+struct MultirateSpectrumAnalyzer
+{
+    public:
+        void prepare(AnalysisService& analysisService, double sampleRate, int numDisplayPoints, float negativeInfinity, int fftOrder = 7);
+        void pushSamples(const float* samples, int numSamples);
+        void produceFFTDataForRendering(const float negativeInfinity);
+
+        int getNumStages() const { return (int)stages.size(); }
+        int getNumDisplayPoints() const { return (int)displayPoints.size(); }
+        float getFrequencyForPoint(int index) const { return displayPoints[(size_t)index].frequency; }
+        SpectrumSmoother& getSmoother() { return smoother; }
+
+        int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
+        bool getFFTData(std::vector<float>& data) { return fftDataFifo.pull(data); }
+
+    private:
+        struct HalfBandDecimator
+        {
+            public:
+                void prepare(const std::vector<float>& taps);
+                bool process(float input, float& output);
+
+            private:
+                const std::vector<float>* coefficients = nullptr;
+                std::vector<float> history;
+                int writeIndex = 0;
+                bool skipNext = false;
+        };
+
+        struct Stage
+        {
+            double sampleRate = 0;
+            HalfBandDecimator decimator;
+            std::vector<float> ring;
+            int ringIndex = 0;
+            int samplesSinceLastFrame = 0;
+            std::vector<float> magnitudes;
+        };
+
+        struct DisplayPoint
+        {
+            float frequency;
+            int stage;
+            float bin;
+        };
+
+        int fftSize = 0;
+        int hopSize = 0;
+        std::shared_ptr<const juce::dsp::FFT> forwardFFT;
+        std::shared_ptr<const std::vector<float>> windowTable;
+        std::vector<float> fftBuffer;
+        std::vector<float> halfBandTaps;
+
+        std::vector<Stage> stages;
+        std::vector<DisplayPoint> displayPoints;
+        std::vector<float> fftData;
+        SpectrumSmoother smoother;
+
+        Fifo<std::vector<float>> fftDataFifo;
+
+        void analyzeStage(Stage& stage);
+};
@@ -0,0 +1,190 @@
+#include "OfflineRenderer.h"
+#include "PluginProcessor.h"
+
+namespace
+{
+    double getPoleRadius(const float* c, int numCoefficients)
+    {
+        // b0..bN followed by a1..aN.
+        auto order = (numCoefficients - 1) / 2;
+
+        if (order == 1) {
+            return std::abs((double)c[2]);
+        }
+
+        if (order != 2) {
+            return 0;
+        }
+
+        double a1 = c[3], a2 = c[4];
+        auto discriminant = a1 * a1 - 4.0 * a2;
+
+        if (discriminant < 0) {
+            return std::sqrt(a2);
+        }
+
+        auto root = std::sqrt(discriminant);
+        return juce::jmax(std::abs(-a1 + root), std::abs(-a1 - root)) * 0.5;
+    }
+
+    std::unique_ptr<SimpleEQAudioProcessor> makeCopy(SimpleEQAudioProcessor& source, const juce::MemoryBlock& state, double sampleRate, int blockSize)
+    {
+        auto copy = std::make_unique<SimpleEQAudioProcessor>();
+
+        copy->setStateInformation(state.getData(), (int)state.getSize());
+        copy->setProcessingBackend(source.getProcessingBackend());
+        copy->setPrecisionMode(source.getPrecisionMode());
+        copy->setNonRealtime(true);
+        copy->setRateAndBufferSizeDetails(sampleRate, blockSize);
+        copy->prepareToPlay(sampleRate, blockSize);
+
+        return copy;
+    }
+
+    // Runs `copy` over input[start, end) block by block, keeping the output from `writeFrom` on.
+    void renderRange(SimpleEQAudioProcessor& copy, const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output,
+                     int start, int writeFrom, int end, int blockSize)
+    {
+        auto numChannels = input.getNumChannels();
+        auto numBufferChannels = juce::jmax(2, copy.getTotalNumInputChannels(), copy.getTotalNumOutputChannels());
+
+        juce::AudioBuffer<float> block(numBufferChannels, blockSize);
+        juce::MidiBuffer midi;
+
+        for (int position = start; position < end; position += blockSize) {
+            auto num = juce::jmin(blockSize, end - position);
+            block.setSize(numBufferChannels, num, false, false, true);
+            block.clear();
+
+            // A mono file feeds both channels and takes the left one back.
+            for (int channel = 0; channel < 2; ++channel) {
+                block.copyFrom(channel, 0, input, juce::jmin(channel, numChannels - 1), position, num);
+            }
+
+            copy.processBlock(block, midi);
+
+            if (position >= writeFrom) {
+                for (int channel = 0; channel < numChannels; ++channel) {
+                    output.copyFrom(channel, position, block, channel, 0, num);
+                }
+            }
+        }
+    }
+}
+
+int OfflineRenderer::getPreRollSamples(const ChainCoefficients& coefficients, double toleranceInDecibels)
+{
+    double radius = 0;
+
+    auto consider = [&radius](const juce::dsp::IIR::Coefficients<float>* c)
+        {
+            if (c != nullptr) {
+                radius = juce::jmax(radius, getPoleRadius(c->coefficients.begin(), c->coefficients.size()));
+            }
+        };
+
+    consider(coefficients.peak.get());
+
+    for (auto* c : coefficients.lowCut) {
+        consider(c);
+    }
+
+    for (auto* c : coefficients.highCut) {
+        consider(c);
+    }
+
+    if (radius <= 0) {
+        return 0;
+    }
+
+    if (radius >= 1) {
+        return -1;
+    }
+
+    // A cascade's transient can outgrow a single pole's by the gain of the sections in front of
+    // it, so the decay is taken to the square of the tolerance.
+    auto tolerance = juce::Decibels::decibelsToGain(2.0 * toleranceInDecibels, -1000.0);
+
+    return (int)std::ceil(std::log(tolerance) / std::log(radius));
+}
+
+void OfflineRenderer::render(SimpleEQAudioProcessor& source, double sampleRate, const juce::AudioBuffer<float>& input,
+                             juce::AudioBuffer<float>& output, const Options& options)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    jassert(output.getNumChannels() == input.getNumChannels() && output.getNumSamples() == input.getNumSamples());
+    jassert(juce::isPositiveAndNotGreaterThan(input.getNumChannels(), 2));
+
+    const auto blockSize = juce::jmax(1, options.blockSize);
+    const auto numSamples = input.getNumSamples();
+    const auto numBlocks = (numSamples + blockSize - 1) / blockSize;
+
+    auto coefficients = makeChainCoefficients(source.getEffectiveChainSettings(), sampleRate);
+    auto preRoll = getPreRollSamples(*coefficients, options.toleranceInDecibels);
+
+    auto numThreads = options.numThreads > 0 ? options.numThreads : juce::SystemStats::getNumCpus();
+    auto numSegments = juce::jlimit(1, juce::jmax(1, numBlocks), numThreads);
+
+    if (preRoll < 0 || getDynamicPeakSettings(source.apvts).enabled) {
+        numSegments = 1;
+    } else if (preRoll > 0) {
+        // Segments shorter than a few pre-rolls would spend most of their time warming up.
+        numSegments = juce::jmin(numSegments, juce::jmax(1, numSamples / (4 * preRoll)));
+    }
+
+    if (numSegments == 1) {
+        renderSerial(source, sampleRate, input, output, blockSize);
+        return;
+    }
+
+    // Whole blocks keep every copy's block boundaries, and so its rounding, in step with the serial render.
+    preRoll = (preRoll + blockSize - 1) / blockSize * blockSize;
+
+    const auto blocksPerSegment = (numBlocks + numSegments - 1) / numSegments;
+
+    juce::MemoryBlock state;
+    source.getStateInformation(state);
+
+    // Copies are built here, as the processor expects to be created on the message thread.
+    std::vector<std::unique_ptr<SimpleEQAudioProcessor>> copies;
+
+    for (int i = 0; i < numSegments; ++i) {
+        copies.push_back(makeCopy(source, state, sampleRate, blockSize));
+    }
+
+    juce::ThreadPool pool(numThreads);
+    std::atomic<int> numRemaining { numSegments };
+    juce::WaitableEvent finished;
+
+    for (int i = 0; i < numSegments; ++i) {
+        auto writeFrom = juce::jmin(numSamples, i * blocksPerSegment * blockSize);
+        auto end = juce::jmin(numSamples, (i + 1) * blocksPerSegment * blockSize);
+        auto start = juce::jmax(0, writeFrom - preRoll);
+        auto* copy = copies[(size_t)i].get();
+
+        pool.addJob([copy, &input, &output, start, writeFrom, end, blockSize, &numRemaining, &finished]
+            {
+                renderRange(*copy, input, output, start, writeFrom, end, blockSize);
+
+                if (--numRemaining == 0) {
+                    finished.signal();
+                }
+            });
+    }
+
+    finished.wait();
+}
+
+void OfflineRenderer::renderSerial(SimpleEQAudioProcessor& source, double sampleRate, const juce::AudioBuffer<float>& input,
+                                   juce::AudioBuffer<float>& output, int blockSize)
+{
+    jassert(juce::isPositiveAndNotGreaterThan(input.getNumChannels(), 2));
+
+    juce::MemoryBlock state;
+    source.getStateInformation(state);
+
+    blockSize = juce::jmax(1, blockSize);
+
+    auto copy = makeCopy(source, state, sampleRate, blockSize);
+    renderRange(*copy, input, output, 0, 0, input.getNumSamples(), blockSize);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+class SimpleEQAudioProcessor;
+struct ChainCoefficients;
+
+// Renders a whole buffer through a processor's current settings on several cores.
+// The buffer is cut into block-aligned segments, each rendered by its own copy of the processor.
+// A copy starts from silence, so it first runs over the pre-roll before its segment and throws
+// that output away. The pre-roll lasts until the slowest pole of the design has decayed below
+// the tolerance, so from the segment start on the copy matches the serial render to within it.
+// Dynamic peak mode follows the level history through a hysteresis and can't be warmed up that
+// way, so it always renders serially.
+struct OfflineRenderer
+{
+    public:
+        struct Options
+        {
+            int blockSize = 512;
+            int numThreads = 0;                     // 0: one per core
+            double toleranceInDecibels = -120.0;    // start-up residual, relative to full scale
+        };
+
+        // Samples until the design's slowest pole has decayed to the tolerance, or -1 if it never does.
+        static int getPreRollSamples(const ChainCoefficients& coefficients, double toleranceInDecibels);
+
+        // Message thread; output must have the input's size. The processor is stereo, so the input
+        // is mono or stereo.
+        static void render(SimpleEQAudioProcessor& source, double sampleRate, const juce::AudioBuffer<float>& input,
+                           juce::AudioBuffer<float>& output, const Options& options);
+
+        // The single-threaded reference.
+        static void renderSerial(SimpleEQAudioProcessor& source, double sampleRate, const juce::AudioBuffer<float>& input,
+                                 juce::AudioBuffer<float>& output, int blockSize);
+};
@@ -1,69 +1,22 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
-void LookAndFeel::drawRotarySlider(
-    juce::Graphics& g,
-    int x, int y, int width, int height,
-    float sliderPosProportional,
-    float rotaryStartAngle,
-    float rotaryEndAngle,
-    juce::Slider& slider)
+namespace
 {
-    using namespace juce;
-
-    auto bounds = Rectangle<float>(x, y, width, height);
-    
-    g.setColour(SLIDER_FILL_COLOR);
-    g.fillEllipse(bounds);
-
-    g.setColour(SLIDER_BORDER_COLOR);
-    g.drawEllipse(bounds, 1.f);
-
-    if (auto* rswl = dynamic_cast<RotarySliderWithLabels*>(&slider)) {
-        auto center = bounds.getCentre();
-
-        Path p;
-
-        Rectangle<float> r;
-        r.setLeft(center.getX() - 2);
-        r.setRight(center.getX() + 2);
-        r.setTop(bounds.getY());
-        r.setBottom(center.getY() - rswl->getTextHeight() * 1.5);
-
-        p.addRoundedRectangle(r, 2.f);
-
-        jassert(rotaryStartAngle < rotaryEndAngle);
-
-        auto sliderAngRad = jmap(sliderPosProportional, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle);
-
-        p.applyTransform(AffineTransform().rotated(sliderAngRad, center.getX(), center.getY()));
-        g.fillPath(p);
-
-        g.setFont(rswl->getTextHeight());
-        auto text = rswl->getDisplayString();
-        auto strWidth = g.getCurrentFont().getStringWidth(text);
-
-        r.setSize(strWidth + 4, rswl->getTextHeight() + 2);
-        r.setCentre(bounds.getCentre());
-
-        g.setColour(SLIDER_FILL_COLOR);
-        g.fillRect(r);
-
-        g.setColour(SLIDER_FONT_COLOR);
-        g.drawFittedText(text, r.toNearestInt(), juce::Justification::centred, 1);
-    }
+    const float rotaryStartAngle = juce::degreesToRadians(180.f + 45.f);
+    const float rotaryEndAngle = juce::degreesToRadians(180.f - 45.f) + juce::MathConstants<float>::twoPi;
 }
 
 juce::String RotarySliderWithLabels::getDisplayString() const
 {
-    if (auto* choiceParam = dynamic_cast<juce::AudioParameterChoice*>(param)) {
+    if (choiceParam != nullptr) {
         return choiceParam->getCurrentChoiceName();
     }
 
     juce::String str;
     bool addK = false;
 
-    if (auto* floatParam = dynamic_cast<juce::AudioParameterFloat*>(param)) {
+    if (floatParam != nullptr) {
         float val = getValue();
 
         if (val > 999.f) {
@@ -91,23 +44,100 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 
 void RotarySliderWithLabels::paint(juce::Graphics& g)
 {
+    TraceScope trace("paint slider");
+
     using namespace juce;
 
-    auto startAng = degreesToRadians(180.f + 45.f);
-    auto endAng = degreesToRadians(180.f - 45.f) + MathConstants<float>::twoPi;
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (artwork.isNull() || scale != artworkScale) {
+        artworkScale = scale;
+        artwork = artworkCache->get(getArtworkKey(scale), [this, scale] { return renderArtwork(scale); });
+    }
+
+    g.drawImage(artwork, getLocalBounds().toFloat());
 
     auto range = getRange();
+    auto center = getSliderBounds().toFloat().getCentre();
+    auto sliderPosProportional = (float)jmap(getValue(), range.getStart(), range.getEnd(), 0.0, 1.0);
+    auto sliderAngRad = jmap(sliderPosProportional, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle);
+
+    g.setColour(SLIDER_BORDER_COLOR);
+    g.fillPath(pointer, AffineTransform::rotation(sliderAngRad, center.getX(), center.getY()));
+
+    g.setFont(getTextHeight());
+
+    if (displayStringDirty) {
+        displayString = getDisplayString();
+        displayStringWidth = g.getCurrentFont().getStringWidth(displayString);
+        displayStringDirty = false;
+    }
+
+    Rectangle<float> r;
+    r.setSize(displayStringWidth + 4, getTextHeight() + 2);
+    r.setCentre(center);
+
+    g.setColour(SLIDER_FILL_COLOR);
+    g.fillRect(r);
+
+    g.setColour(SLIDER_FONT_COLOR);
+    g.drawFittedText(displayString, r.toNearestInt(), juce::Justification::centred, 1);
+}
+
+void RotarySliderWithLabels::resized()
+{
+    juce::Slider::resized();
+
+    artwork = {};
+
+    auto bounds = getSliderBounds().toFloat();
+    auto center = bounds.getCentre();
+
+    juce::Rectangle<float> r;
+    r.setLeft(center.getX() - 2);
+    r.setRight(center.getX() + 2);
+    r.setTop(bounds.getY());
+    r.setBottom(center.getY() - getTextHeight() * 1.5);
+
+    pointer.clear();
+    pointer.addRoundedRectangle(r, 2.f);
+}
+
+void RotarySliderWithLabels::valueChanged()
+{
+    displayStringDirty = true;
+}
+
+juce::String RotarySliderWithLabels::getArtworkKey(float scale) const
+{
+    juce::String key;
+    key << getWidth() << "x" << getHeight() << "@" << scale;
+
+    for (const auto& label : labels) {
+        key << "|" << label.pos << ":" << label.label;
+    }
+
+    return key;
+}
+
+juce::Image RotarySliderWithLabels::renderArtwork(float scale) const
+{
+    using namespace juce;
+
+    Image image(Image::ARGB, jmax(1, roundToInt(getWidth() * scale)), jmax(1, roundToInt(getHeight() * scale)), true);
+    Graphics g(image);
+    g.addTransform(AffineTransform::scale(scale));
+
     auto sliderBounds = getSliderBounds();
+    auto bounds = sliderBounds.toFloat();
 
-    getLookAndFeel().drawRotarySlider(
-        g,
-        sliderBounds.getX(), sliderBounds.getY(), sliderBounds.getWidth(),sliderBounds.getHeight(),
-        jmap(getValue(), range.getStart(), range.getEnd(), 0.0, 1.0),
-        startAng, endAng,
-        *this
-    );
+    g.setColour(SLIDER_FILL_COLOR);
+    g.fillEllipse(bounds);
+
+    g.setColour(SLIDER_BORDER_COLOR);
+    g.drawEllipse(bounds, 1.f);
 
-    auto center = sliderBounds.toFloat().getCentre();
+    auto center = bounds.getCentre();
     auto radius = sliderBounds.getWidth() * 0.5f;
 
     g.setColour(Colour(0u, 172u, 1u));
@@ -120,7 +150,7 @@ void RotarySliderWithLabels::paint(juce::Graphics& g)
         jassert(0.f <= pos);
         jassert(pos <= 1.f);
 
-        auto ang = jmap(pos, 0.f, 1.f, startAng, endAng);
+        auto ang = jmap(pos, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle);
 
         auto c = center.getPointOnCircumference(radius + getTextHeight() * 0.5f + 1, ang);
 
@@ -131,8 +161,9 @@ void RotarySliderWithLabels::paint(juce::Graphics& g)
         r.setY(r.getY() + getTextHeight());
 
         g.drawFittedText(str, r.toNearestInt(), juce::Justification::centred, 1);
-
     }
+
+    return image;
 }
 
 juce::Rectangle<int> RotarySliderWithLabels::getSliderBounds() const
@@ -152,96 +183,698 @@ juce::Rectangle<int> RotarySliderWithLabels::getSliderBounds() const
 }
 
 ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) :
-audioProcessor(p),
-leftChannelFifo(&p.leftChannelFifo)
+audioProcessor(p)
+{
+    updateChain();
+}
+
+ResponseCurveComponent::~ResponseCurveComponent()
 {
-    const auto& params = audioProcessor.getParameters();
-    for (auto param : params) {
-        param->addListener(this);
+    if (analyzerStarted) {
+        analysisService->unregisterClient(*this);
+        audioProcessor.analyzerFeed.detach();
     }
 
-    leftChannelFFTDataGenerator.changeOrder(FFTOrder::oreder2048);
-    monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+    if (inputFeedAcquired) {
+        audioProcessor.inputFeed.detach();
+    }
+}
 
-    updateChain();
+void ResponseCurveComponent::startAnalyzer()
+{
+    if (analyzerStarted) {
+        return;
+    }
+
+    applyAnalyzerQuality();
 
-    startTimer(60);
+    // The feed holds no storage until its first view starts.
+    audioProcessor.analyzerFeed.attach();
+    analyzerReader = audioProcessor.analyzerFeed.createReader();
+
+    analyzerStarted = true;
+    analysisService->registerClient(*this);
 }
 
-ResponseCurveComponent::~ResponseCurveComponent()
+void ResponseCurveComponent::applyAnalyzerQuality()
 {
-    const auto& params = audioProcessor.getParameters();
-    for (auto param : params) {
-        param->removeListener(this);
+    const auto& level = AnalyzerGovernor::getLevel(governor.getCurrentLevel());
+
+    const juce::ScopedLock sl(analyzerLock);
+
+    if (level.fftOrder != analyzerOrder) {
+        analyzerOrder = level.fftOrder;
+
+        stereoFFTDataGenerator.changeOrder(static_cast<FFTOrder>(analyzerOrder), *analysisService);
+        stereoBuffer.setSize(2, stereoFFTDataGenerator.getFFTSize());
+        stereoBuffer.clear();
+
+        if (analyzerMode == AnalyzerMode::FFT) {
+            spectrumFrame.clear();
+
+            for (int i = 0; i < 2; ++i) {
+                analyzerPaths[i].clear();
+                peakPaths[i].clear();
+            }
+        }
+
+        if (measurePost) {
+            preparePostGenerator();
+        }
     }
+
+    analysisOverlap = level.overlap;
+    analysisFrameDivisor = level.frameDivisor;
+
+    incomingBuffer.setSize(2, juce::jmax(stereoFFTDataGenerator.getFFTSize() / analysisOverlap, constantQChunkSize));
+    midScratch.resize((size_t)constantQChunkSize);
+
+    // The smoothing time constants follow the frame rate, which follows the hop.
+    smootherSampleRate = 0;
 }
 
-void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue)
+void ResponseCurveComponent::updateGovernor()
 {
-    parametersChanged.set(true);
+    auto now = juce::Time::getHighResolutionTicks();
+
+    if (lastGovernorTicks != 0) {
+        auto editorTicks = analysisTicks.exchange(0) + messageThreadTicks;
+        auto editorSeconds = juce::Time::highResolutionTicksToSeconds(editorTicks);
+        auto intervalSeconds = juce::Time::highResolutionTicksToSeconds(now - lastGovernorTicks);
+
+        if (governor.update(editorSeconds, intervalSeconds, audioProcessor.getAudioLoad())) {
+            applyAnalyzerQuality();
+        }
+    }
+
+    messageThreadTicks = 0;
+    lastGovernorTicks = now;
+}
+
+void ResponseCurveComponent::runAnalysis()
+{
+    TraceRecorder::nameCurrentThread("Analysis");
+
+    auto start = juce::Time::getHighResolutionTicks();
+
+    {
+        const juce::ScopedLock sl(analyzerLock);
+
+        // Skipped slots leave their audio in the feed; the next analysed slot only frames the newest of it.
+        if (++analysisSlot % analysisFrameDivisor == 0) {
+            if (analyzerMode == AnalyzerMode::ConstantQ) {
+                prepareConstantQAnalyzer();
+            }
+            else {
+                prepareStereoSmoother();
+            }
+
+            pullAudioIntoAnalyzer();
+        }
+    }
+
+    analysisTicks.fetch_add(juce::Time::getHighResolutionTicks() - start, std::memory_order_relaxed);
+}
+
+void ResponseCurveComponent::handleAnalysisResults()
+{
+    auto start = juce::Time::getHighResolutionTicks();
+
+    updateAnalyzerPaths();
+
+    updateChain();
+
+    messageThreadTicks += juce::Time::getHighResolutionTicks() - start;
+
+    updateGovernor();
+}
+
+void ResponseCurveComponent::pullAudioIntoAnalyzer()
+{
+    auto& feed = audioProcessor.analyzerFeed;
+
+    if (analyzerMode == AnalyzerMode::ConstantQ) {
+        bool consumed = false;
+
+        while (feed.read(analyzerReader, incomingBuffer, constantQChunkSize)) {
+            juce::FloatVectorOperations::add(midScratch.data(), incomingBuffer.getReadPointer(0), incomingBuffer.getReadPointer(1), constantQChunkSize);
+            juce::FloatVectorOperations::multiply(midScratch.data(), 0.5f, constantQChunkSize);
+
+            constantQAnalyzer.pushSamples(midScratch.data(), constantQChunkSize);
+            consumed = true;
+        }
+
+        // The constant-Q view is refreshed once per analysis slot, whatever the host block size.
+        if (consumed) {
+            constantQAnalyzer.getSmoother().setFrameRate(1000.f / float(AnalysisService::frameIntervalMs * analysisFrameDivisor));
+            constantQAnalyzer.produceFFTDataForRendering(analyzerNegativeInfinity);
+        }
+
+        return;
+    }
+
+    // One frame per hop of new audio, whatever the host block size.
+    const int hop = stereoFFTDataGenerator.getFFTSize() / analysisOverlap;
+
+    if (!analysesInput()) {
+        pullFeed(feed, analyzerReader, stereoBuffer, stereoFFTDataGenerator, hop);
+        return;
+    }
+
+    pullFeed(audioProcessor.inputFeed, inputReader, stereoBuffer, stereoFFTDataGenerator, hop);
+
+    if (measurePost) {
+        pullFeed(feed, postReader, postBuffer, postGenerator, hop);
+    }
 }
 
-void ResponseCurveComponent::timerCallback()
+void ResponseCurveComponent::pullFeed(BroadcastRing<float>& feed, BroadcastRing<float>::Reader& reader, juce::AudioBuffer<float>& window,
+                                      StereoGenerator& generator, int hop)
 {
-    juce::AudioBuffer<float> tempIncomingBuffer;
+    const int total = window.getNumSamples();
+    const auto sampleRate = audioProcessor.getSampleRate();
 
-    while (leftChannelFifo->getNumCompleteBuffersAvailable() > 0) {
-        if (leftChannelFifo->getAudioBuffer(tempIncomingBuffer)) {
-            int size = tempIncomingBuffer.getNumSamples();
+    // After skipped slots only one slot's worth of frames is made, so the frame rate really drops
+    // with the divisor. The window is refilled from the audio just before them first, rather than
+    // framed across the gap.
+    int numRefills = 0;
 
+    if (analysisFrameDivisor > 1) {
+        auto numToKeep = juce::roundToInt(sampleRate * AnalysisService::frameIntervalMs / 1000.0) + total - hop;
+
+        if (feed.getNumAvailable(reader) > numToKeep) {
+            feed.skipToLatest(reader, numToKeep);
+            numRefills = total / hop - 1;
+        }
+    }
+
+    generator.getSmoother().setFrameRate(float(sampleRate / hop / analysisFrameDivisor));
+
+    while (feed.read(reader, incomingBuffer, hop)) {
+        for (int channel = 0; channel < 2; ++channel) {
             juce::FloatVectorOperations::copy(
-                monoBuffer.getWritePointer(0, 0),
-                monoBuffer.getReadPointer(0, size),
-                monoBuffer.getNumSamples() - size
+                window.getWritePointer(channel, 0),
+                window.getReadPointer(channel, hop),
+                total - hop
             );
 
             juce::FloatVectorOperations::copy(
-                monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
-                tempIncomingBuffer.getReadPointer(0, 0),
-                size
+                window.getWritePointer(channel, total - hop),
+                incomingBuffer.getReadPointer(channel, 0),
+                hop
             );
+        }
 
-            leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
+        if (numRefills > 0) {
+            --numRefills;
+            continue;
         }
+
+        generator.produceFFTDataForRendering(window, analyzerNegativeInfinity);
     }
+}
 
-    if (parametersChanged.compareAndSetBool(false, true)) {
-        updateChain();
+void ResponseCurveComponent::updateAnalyzerPaths()
+{
+    bool hasNewFrame = false;
+
+    if (analyzerMode == AnalyzerMode::ConstantQ) {
+        while (constantQAnalyzer.getNumAvailableFFTDataBlocks() > 0) {
+            if (constantQAnalyzer.getFFTData(spectrumFrame)) {
+                pushSpectrogramFrame();
+                hasNewFrame = true;
+            }
+        }
+    }
+    else {
+        while (stereoFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0) {
+            if (stereoFFTDataGenerator.getFFTData(spectrumFrame)) {
+                pushSpectrogramFrame();
+                hasNewFrame = true;
+            }
+        }
+
+        while (postGenerator.getNumAvailableFFTDataBlocks() > 0) {
+            hasNewFrame = postGenerator.getFFTData(postFrame) || hasNewFrame;
+        }
+    }
 
+    if (hasNewFrame) {
+        rebuildAnalyzerPaths();
         repaint();
     }
 }
 
+void ResponseCurveComponent::pushSpectrogramFrame()
+{
+    // The spectrogram shows the mid signal, the one spectrum both analyzer modes produce.
+    if (analyzerMode == AnalyzerMode::ConstantQ) {
+        spectrogram.pushFrame(spectrumFrame.data(), (int)spectrumFrame.size() / 2,
+                              SpectrogramComponent::Layout::LogPoints, 0);
+        return;
+    }
+
+    auto numBins = stereoFFTDataGenerator.getNumBins();
+    auto* mid = spectrumFrame.data() + StereoGenerator::MidSpectrum * numBins;
+
+    // Pre/post analyzes the input, so the output it shows is derived here as well.
+    if (analysesInput()) {
+        mid = deriveOutputSpectrum(mid, numBins);
+    }
+
+    spectrogram.pushFrame(mid, numBins, SpectrogramComponent::Layout::LinearBins, audioProcessor.getSampleRate());
+}
+
+void ResponseCurveComponent::rebuildAnalyzerPaths()
+{
+    if (spectrumFrame.empty()) {
+        return;
+    }
+
+    auto area = getAnalisysArea().toFloat();
+
+    if (analyzerMode == AnalyzerMode::ConstantQ) {
+        auto numPoints = (int)spectrumFrame.size() / 2;
+
+        analyzerPaths[0] = makeConstantQPath(spectrumFrame.data(), numPoints, area);
+        peakPaths[0] = makeConstantQPath(spectrumFrame.data() + numPoints, numPoints, area);
+        analyzerPaths[1].clear();
+        peakPaths[1].clear();
+        return;
+    }
+
+    auto numBins = stereoFFTDataGenerator.getNumBins();
+    auto peaksOffset = StereoGenerator::NumSpectra * numBins;
+
+    if (analyzerView == AnalyzerView::PrePost) {
+        auto* pre = spectrumFrame.data() + StereoGenerator::MidSpectrum * numBins;
+
+        analyzerPaths[0] = makeAnalyzerPath(pre, numBins, area);
+        peakPaths[0] = makeAnalyzerPath(pre + peaksOffset, numBins, area);
+        analyzerPaths[1] = makeAnalyzerPath(deriveOutputSpectrum(pre, numBins), numBins, area);
+        peakPaths[1] = makeAnalyzerPath(deriveOutputSpectrum(pre + peaksOffset, numBins), numBins, area);
+
+        measuredPostPath.clear();
+
+        if (measurePost && (int)postFrame.size() == (int)spectrumFrame.size()) {
+            measuredPostPath = makeAnalyzerPath(postFrame.data() + StereoGenerator::MidSpectrum * numBins, numBins, area);
+        }
+
+        return;
+    }
+
+    auto first = analyzerView == AnalyzerView::LeftRight ? StereoGenerator::LeftSpectrum : StereoGenerator::MidSpectrum;
+
+    for (int i = 0; i < 2; ++i) {
+        auto* spectrum = spectrumFrame.data() + (first + i) * numBins;
+
+        analyzerPaths[i] = makeAnalyzerPath(spectrum, numBins, area);
+        peakPaths[i] = makeAnalyzerPath(spectrum + peaksOffset, numBins, area);
+    }
+}
+
+juce::Path ResponseCurveComponent::makeAnalyzerPath(const float* decibels, int numBins, juce::Rectangle<float> area) const
+{
+    using namespace juce;
+
+    Path p;
+
+    auto sampleRate = audioProcessor.getSampleRate();
+    if (sampleRate <= 0 || numBins == 0) {
+        return p;
+    }
+
+    auto binWidth = sampleRate / double(numBins * 2);
+    auto map = [area](float db)
+        {
+            return jmap(db, analyzerNegativeInfinity, 0.f, area.getBottom(), area.getY());
+        };
+
+    p.startNewSubPath(area.getX(), map(decibels[0]));
+
+    for (int bin = 1; bin < numBins; ++bin) {
+        auto normX = mapFromLog10(float(bin * binWidth), 20.f, 20000.f);
+
+        if (normX < 0.f) {
+            continue;
+        }
+
+        if (normX > 1.f) {
+            break;
+        }
+
+        p.lineTo(area.getX() + area.getWidth() * normX, map(decibels[bin]));
+    }
+
+    return p;
+}
+
+const float* ResponseCurveComponent::deriveOutputSpectrum(const float* decibels, int numBins)
+{
+    updateBinResponse();
+
+    derivedSpectrum.resize((size_t)numBins);
+    juce::FloatVectorOperations::add(derivedSpectrum.data(), decibels, binResponse.data(), numBins);
+    juce::FloatVectorOperations::max(derivedSpectrum.data(), derivedSpectrum.data(), analyzerNegativeInfinity, numBins);
+
+    return derivedSpectrum.data();
+}
+
+void ResponseCurveComponent::updateBinResponse()
+{
+    auto numBins = stereoFFTDataGenerator.getNumBins();
+    auto mode = static_cast<ProcessingMode>(audioProcessor.apvts.getRawParameterValue(PROCESSING_MODE_PARAM_NAME)->load());
+
+    if (chainCoefficients == binResponseCoefficients && mode == binResponseMode && (int)binResponse.size() == numBins) {
+        return;
+    }
+
+    binResponseCoefficients = chainCoefficients;
+    binResponseMode = mode;
+    binResponse.assign((size_t)numBins, 0.f);
+
+    // The mid spectrum is drawn, and in side-only mode the mid passes through untouched.
+    if (chainCoefficients == nullptr || mode == ProcessingMode::SideOnly) {
+        return;
+    }
+
+    // The response is smooth on a log axis, so it is evaluated at a few hundred points and
+    // interpolated for each bin rather than evaluated per bin.
+    constexpr int numPoints = 512;
+    const auto sampleRate = chainCoefficients->sampleRate;
+    const auto lowest = 10.0, highest = sampleRate / 2;
+    const auto span = std::log(highest / lowest);
+
+    std::array<float, numPoints> points;
+
+    for (int i = 0; i < numPoints; ++i) {
+        auto frequency = lowest * std::exp(span * i / (numPoints - 1));
+        points[(size_t)i] = juce::Decibels::gainToDecibels((float)chainCoefficients->getMagnitudeForFrequency(frequency), -100.f);
+    }
+
+    const auto binWidth = sampleRate / double(numBins * 2);
+
+    for (int bin = 0; bin < numBins; ++bin) {
+        auto position = std::log(juce::jmax(lowest, bin * binWidth) / lowest) / span * (numPoints - 1);
+        auto index = juce::jmin((int)position, numPoints - 2);
+        auto fraction = (float)(position - index);
+
+        binResponse[(size_t)bin] = points[(size_t)index] + fraction * (points[(size_t)index + 1] - points[(size_t)index]);
+    }
+}
+
+juce::Path ResponseCurveComponent::makeConstantQPath(const float* decibels, int numPoints, juce::Rectangle<float> area) const
+{
+    using namespace juce;
+
+    Path p;
+
+    if (numPoints < 2) {
+        return p;
+    }
+
+    // Display points are already log-spaced across 20Hz..20kHz, so x is linear in the index.
+    auto map = [area](float db)
+        {
+            return jmap(db, analyzerNegativeInfinity, 0.f, area.getBottom(), area.getY());
+        };
+
+    p.startNewSubPath(area.getX(), map(decibels[0]));
+
+    for (int i = 1; i < numPoints; ++i) {
+        p.lineTo(area.getX() + area.getWidth() * float(i) / float(numPoints - 1), map(decibels[i]));
+    }
+
+    return p;
+}
+
+void ResponseCurveComponent::prepareConstantQAnalyzer()
+{
+    auto sampleRate = audioProcessor.getSampleRate();
+
+    if (sampleRate != constantQSampleRate) {
+        constantQSampleRate = sampleRate;
+        constantQAnalyzer.prepare(*analysisService, sampleRate, 256, analyzerNegativeInfinity);
+        constantQAnalyzer.getSmoother().setSettings(smootherSettings);
+    }
+}
+
+void ResponseCurveComponent::prepareStereoSmoother()
+{
+    auto sampleRate = audioProcessor.getSampleRate();
+
+    if (sampleRate > 0 && sampleRate != smootherSampleRate) {
+        smootherSampleRate = sampleRate;
+
+        auto framesPerSecond = float(sampleRate / (stereoFFTDataGenerator.getFFTSize() / analysisOverlap));
+        stereoFFTDataGenerator.prepareSmoother(sampleRate, framesPerSecond, analyzerNegativeInfinity);
+        stereoFFTDataGenerator.getSmoother().setSettings(smootherSettings);
+
+        if (measurePost) {
+            postGenerator.prepareSmoother(sampleRate, framesPerSecond, analyzerNegativeInfinity);
+            postGenerator.getSmoother().setSettings(smootherSettings);
+        }
+    }
+}
+
+void ResponseCurveComponent::preparePostGenerator()
+{
+    postGenerator.changeOrder(static_cast<FFTOrder>(analyzerOrder), *analysisService);
+    postBuffer.setSize(2, postGenerator.getFFTSize());
+    postBuffer.clear();
+    postReader = audioProcessor.analyzerFeed.createReader();
+    postFrame.clear();
+
+    smootherSampleRate = 0;
+}
+
+void ResponseCurveComponent::updateAnalyzerSource()
+{
+    if (analysesInput() == inputFeedAcquired) {
+        return;
+    }
+
+    inputFeedAcquired = analysesInput();
+
+    // The new source is read from now on, rather than from whatever it held when last used.
+    if (inputFeedAcquired) {
+        audioProcessor.inputFeed.attach();
+        inputReader = audioProcessor.inputFeed.createReader();
+        postReader = audioProcessor.analyzerFeed.createReader();
+    } else {
+        audioProcessor.inputFeed.detach();
+        analyzerReader = audioProcessor.analyzerFeed.createReader();
+    }
+
+    stereoBuffer.clear();
+    postBuffer.clear();
+    spectrumFrame.clear();
+    postFrame.clear();
+}
+
+void ResponseCurveComponent::setMeasurePost(bool shouldMeasure)
+{
+    {
+        const juce::ScopedLock sl(analyzerLock);
+
+        measurePost = shouldMeasure;
+
+        if (measurePost && analyzerOrder != 0) {
+            preparePostGenerator();
+        }
+    }
+
+    measuredPostPath.clear();
+    repaint();
+}
+
+void ResponseCurveComponent::setSmootherSettings(const SpectrumSmoother::Settings& newSettings)
+{
+    smootherSettings = newSettings;
+
+    stereoFFTDataGenerator.getSmoother().setSettings(smootherSettings);
+    postGenerator.getSmoother().setSettings(smootherSettings);
+    constantQAnalyzer.getSmoother().setSettings(smootherSettings);
+}
+
+void ResponseCurveComponent::setAnalyzerMode(AnalyzerMode newMode)
+{
+    const juce::ScopedLock sl(analyzerLock);
+
+    analyzerMode = newMode;
+    updateAnalyzerSource();
+
+    if (analyzerMode == AnalyzerMode::ConstantQ) {
+        prepareConstantQAnalyzer();
+    }
+
+    spectrumFrame.clear();
+
+    for (int i = 0; i < 2; ++i) {
+        analyzerPaths[i].clear();
+        peakPaths[i].clear();
+    }
+
+    spectrogram.clear();
+    repaint();
+}
+
+void ResponseCurveComponent::showAnalyzerMenu()
+{
+    juce::PopupMenu menu;
+    juce::Component::SafePointer<ResponseCurveComponent> safeThis(this);
+
+    menu.addSectionHeader("Analyzer");
+    menu.addItem("FFT", true, analyzerMode == AnalyzerMode::FFT, [safeThis]
+        {
+            if (safeThis != nullptr) safeThis->setAnalyzerMode(AnalyzerMode::FFT);
+        });
+    menu.addItem("Constant-Q", true, analyzerMode == AnalyzerMode::ConstantQ, [safeThis]
+        {
+            if (safeThis != nullptr) safeThis->setAnalyzerMode(AnalyzerMode::ConstantQ);
+        });
+
+    menu.addSeparator();
+    menu.addItem("Averaging", true, smootherSettings.averagingTimeMs > 0, [safeThis]
+        {
+            if (safeThis != nullptr) {
+                auto settings = safeThis->smootherSettings;
+                settings.averagingTimeMs = settings.averagingTimeMs > 0 ? 0.f : 300.f;
+                safeThis->setSmootherSettings(settings);
+            }
+        });
+    menu.addItem("Peak hold", true, smootherSettings.peakHold, [safeThis]
+        {
+            if (safeThis != nullptr) {
+                auto settings = safeThis->smootherSettings;
+                settings.peakHold = !settings.peakHold;
+                safeThis->setSmootherSettings(settings);
+            }
+        });
+    menu.addItem("Tilt 4.5 dB/oct", true, smootherSettings.tiltDbPerOctave != 0, [safeThis]
+        {
+            if (safeThis != nullptr) {
+                auto settings = safeThis->smootherSettings;
+                settings.tiltDbPerOctave = settings.tiltDbPerOctave != 0 ? 0.f : 4.5f;
+                safeThis->setSmootherSettings(settings);
+            }
+        });
+
+    // The governor moves the quality between these limits as the load allows.
+    juce::PopupMenu maximumMenu, minimumMenu;
+
+    for (int i = 0; i < AnalyzerGovernor::numLevels; ++i) {
+        auto* name = AnalyzerGovernor::getLevel(i).name;
+
+        maximumMenu.addItem(name, true, governor.getCeiling() == i, [safeThis, i]
+            {
+                if (safeThis != nullptr && safeThis->governor.setCeiling(i)) safeThis->applyAnalyzerQuality();
+            });
+        minimumMenu.addItem(name, true, governor.getFloor() == i, [safeThis, i]
+            {
+                if (safeThis != nullptr && safeThis->governor.setFloor(i)) safeThis->applyAnalyzerQuality();
+            });
+    }
+
+    menu.addSeparator();
+    menu.addItem(juce::String("Quality: ") + AnalyzerGovernor::getLevel(governor.getCurrentLevel()).name, false, false, [] {});
+    menu.addSubMenu("Maximum quality", maximumMenu);
+    menu.addSubMenu("Minimum quality", minimumMenu);
+
+    menu.addSeparator();
+    menu.addItem("Left / Right", analyzerMode == AnalyzerMode::FFT, analyzerView == AnalyzerView::LeftRight, [safeThis]
+        {
+            if (safeThis != nullptr) safeThis->setAnalyzerView(AnalyzerView::LeftRight);
+        });
+    menu.addItem("Mid / Side", analyzerMode == AnalyzerMode::FFT, analyzerView == AnalyzerView::MidSide, [safeThis]
+        {
+            if (safeThis != nullptr) safeThis->setAnalyzerView(AnalyzerView::MidSide);
+        });
+    menu.addItem("Pre / Post", analyzerMode == AnalyzerMode::FFT, analyzerView == AnalyzerView::PrePost, [safeThis]
+        {
+            if (safeThis != nullptr) safeThis->setAnalyzerView(AnalyzerView::PrePost);
+        });
+    menu.addItem("Measured post", analysesInput(), measurePost, [safeThis]
+        {
+            if (safeThis != nullptr) safeThis->setMeasurePost(!safeThis->measurePost);
+        });
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(this));
+}
+
+void ResponseCurveComponent::setAnalyzerView(AnalyzerView newView)
+{
+    {
+        const juce::ScopedLock sl(analyzerLock);
+
+        analyzerView = newView;
+        updateAnalyzerSource();
+    }
+
+    rebuildAnalyzerPaths();
+    repaint();
+}
+
+void ResponseCurveComponent::mouseDown(const juce::MouseEvent& event)
+{
+    if (event.mods.isPopupMenu()) {
+        showAnalyzerMenu();
+        return;
+    }
+
+    setAnalyzerView(analyzerView == AnalyzerView::LeftRight ? AnalyzerView::MidSide : AnalyzerView::LeftRight);
+}
+
 void ResponseCurveComponent::updateChain()
 {
-    auto chainSettings = getChainSettings(audioProcessor.apvts);
-    auto peakCoeffitients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoeffitients);
+    TraceScope trace("updateChain");
+
+    auto latest = audioProcessor.getCoefficientsForDisplay();
 
-    auto lowCutCoeffitients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highCutCoeffitients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
+    if (latest != chainCoefficients) {
+        chainCoefficients = latest;
 
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoeffitients, chainSettings.lowCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoeffitients, chainSettings.highCutSlope);
+        repaint();
+    }
 }
 
 void ResponseCurveComponent::paint(juce::Graphics& g)
 {
+    TraceScope trace("paint response curve");
+
     using namespace juce;
 
+    auto paintStart = Time::getHighResolutionTicks();
+
     g.fillAll(Colours::black);
 
+    // The grid is rendered at the physical pixel scale, so drawing it is a 1:1 blit.
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (background.isNull() || scale != backgroundScale) {
+        backgroundScale = scale;
+
+        juce::String key;
+        key << "response grid " << getWidth() << "x" << getHeight() << "@" << scale;
+        background = imageCache->get(key, [this, scale] { return renderBackground(scale); });
+    }
+
     g.drawImage(background, getLocalBounds().toFloat());
 
-    auto responseArea = getAnalisysArea();
+    // The analyzer is set up once the first frame is on screen, so opening the editor isn't held up by it.
+    if (!analyzerStarted && !analyzerStartPending) {
+        analyzerStartPending = true;
 
-    auto w = responseArea.getWidth();
+        juce::Component::SafePointer<ResponseCurveComponent> safeThis(this);
+        juce::MessageManager::callAsync([safeThis]
+            {
+                if (safeThis != nullptr) safeThis->startAnalyzer();
+            });
+    }
 
-    auto& lowCut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highCut = monoChain.get<ChainPositions::HighCut>();
+    auto responseArea = getAnalisysArea();
 
-    auto sampleRate = audioProcessor.getSampleRate();
+    auto w = responseArea.getWidth();
 
     std::vector<double> mags;
 
@@ -251,34 +884,8 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
         double mag = 1.f;
         auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
 
-        if (!monoChain.isBypassed<ChainPositions::Peak>()) {
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-
-        if (!lowCut.isBypassed<0>()) {
-            mag *= lowCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!lowCut.isBypassed<1>()) {
-            mag *= lowCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!lowCut.isBypassed<2>()) {
-            mag *= lowCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!lowCut.isBypassed<3>()) {
-            mag *= lowCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-
-        if (!highCut.isBypassed<0>()) {
-            mag *= highCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!highCut.isBypassed<1>()) {
-            mag *= highCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!highCut.isBypassed<2>()) {
-            mag *= highCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!highCut.isBypassed<3>()) {
-            mag *= highCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        if (chainCoefficients != nullptr) {
+            mag = chainCoefficients->getMagnitudeForFrequency(freq);
         }
 
         mags[i] = Decibels::gainToDecibels(mag);
@@ -300,19 +907,57 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
         responseCurve.lineTo(getRenderArea().getX() + i, map(mags[i]));
     }
 
+    auto firstColour = analyzerView == AnalyzerView::LeftRight ? Colours::skyblue : Colours::lightgreen;
+    auto secondColour = analyzerView == AnalyzerView::LeftRight ? Colours::lightyellow : Colours::hotpink;
+
+    if (analyzerView == AnalyzerView::PrePost) {
+        firstColour = Colours::grey;
+        secondColour = Colours::aquamarine;
+    }
+
+    if (smootherSettings.peakHold) {
+        g.setColour(firstColour.withAlpha(0.4f));
+        g.strokePath(peakPaths[0], PathStrokeType(1));
+
+        g.setColour(secondColour.withAlpha(0.4f));
+        g.strokePath(peakPaths[1], PathStrokeType(1));
+    }
+
+    g.setColour(firstColour);
+    g.strokePath(analyzerPaths[0], PathStrokeType(1));
+
+    g.setColour(secondColour);
+    g.strokePath(analyzerPaths[1], PathStrokeType(1));
+
+    if (analysesInput() && measurePost) {
+        g.setColour(Colours::white.withAlpha(0.5f));
+        g.strokePath(measuredPostPath, PathStrokeType(1));
+    }
+
     g.setColour(Colours::orange);
     g.drawRoundedRectangle(responseArea.toFloat(), 4.f, 1.f);
 
     g.setColour(Colours::white);
     g.strokePath(responseCurve, PathStrokeType(2));
+
+    messageThreadTicks += Time::getHighResolutionTicks() - paintStart;
 }
 
 void ResponseCurveComponent::resized()
+{
+    background = {};
+
+    rebuildAnalyzerPaths();
+}
+
+juce::Image ResponseCurveComponent::renderBackground(float scale)
 {
     using namespace juce;
-    background = Image(Image::PixelFormat::RGB, getWidth(), getHeight(), true);
 
-    Graphics g(background);
+    Image image(Image::PixelFormat::RGB, jmax(1, roundToInt(getWidth() * scale)), jmax(1, roundToInt(getHeight() * scale)), true);
+
+    Graphics g(image);
+    g.addTransform(AffineTransform::scale(scale));
 
     Array<float> freqs
     {
@@ -404,6 +1049,8 @@ void ResponseCurveComponent::resized()
 
         g.drawFittedText(str, r, juce::Justification::centred, 1);
     }
+
+    return image;
 }
 
 juce::Rectangle<int> ResponseCurveComponent::getRenderArea()
@@ -428,9 +1075,12 @@ juce::Rectangle<int> ResponseCurveComponent::getAnalisysArea()
 
 SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor(SimpleEQAudioProcessor& p) : AudioProcessorEditor(&p),
     responseCurveComponent(p),
+    levelMeterComponent(p),
     peakFreqSlider(*p.apvts.getParameter(PEAK_FREQ_PARAM_NAME), "Hz"),
     peakGainSlider(*p.apvts.getParameter(PEAK_GAIN_PARAM_NAME), "dB"),
     peakQualitySlider(*p.apvts.getParameter(PEAK_QUALITY_PARAM_NAME), ""),
+    peakThresholdSlider(*p.apvts.getParameter(PEAK_THRESHOLD_PARAM_NAME), "dB"),
+    peakRangeSlider(*p.apvts.getParameter(PEAK_RANGE_PARAM_NAME), "dB"),
     lowCutFreqSlider(*p.apvts.getParameter(LOW_CUT_FREQ_PARAM_NAME), "Hz"),
     highCutFreqSlider(*p.apvts.getParameter(HIGH_CUT_FREQ_PARAM_NAME), "Hz"),
     lowCutSlopeSlider(*p.apvts.getParameter(LOW_CUT_SLOPE_PARAM_NAME), "dB"),
@@ -439,10 +1089,16 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor(SimpleEQAudioProcesso
     peakFreqSliderAttachment(p.apvts, PEAK_FREQ_PARAM_NAME, peakFreqSlider),
     peakGainSliderAttachment(p.apvts, PEAK_GAIN_PARAM_NAME, peakGainSlider),
     peakQualitySliderAttachment(p.apvts, PEAK_QUALITY_PARAM_NAME, peakQualitySlider),
+    peakThresholdSliderAttachment(p.apvts, PEAK_THRESHOLD_PARAM_NAME, peakThresholdSlider),
+    peakRangeSliderAttachment(p.apvts, PEAK_RANGE_PARAM_NAME, peakRangeSlider),
     lowCutFreqSliderAttachment(p.apvts, LOW_CUT_FREQ_PARAM_NAME, lowCutFreqSlider),
     highCutFreqSliderAttachment(p.apvts, HIGH_CUT_FREQ_PARAM_NAME, highCutFreqSlider),
     lowCutSlopeSliderAttachment(p.apvts, LOW_CUT_SLOPE_PARAM_NAME, lowCutSlopeSlider),
-    highCutSlopeSliderAttachment(p.apvts, HIGH_CUT_SLOPE_PARAM_NAME, highCutSlopeSlider)
+    highCutSlopeSliderAttachment(p.apvts, HIGH_CUT_SLOPE_PARAM_NAME, highCutSlopeSlider),
+    peakDynamicButtonAttachment(p.apvts, PEAK_DYNAMIC_PARAM_NAME, peakDynamicButton),
+    peakSidechainButtonAttachment(p.apvts, PEAK_SIDECHAIN_PARAM_NAME, peakSidechainButton),
+    morphButtonAttachment(p.apvts, MORPH_PARAM_NAME, morphButton),
+    morphSliderAttachment(p.apvts, MORPH_AMOUNT_PARAM_NAME, morphSlider)
 {
     peakFreqSlider.labels.add({ 0.f, "20Hz" });
     peakFreqSlider.labels.add({ 1.f, "20kHz" });
@@ -453,6 +1109,12 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor(SimpleEQAudioProcesso
     peakQualitySlider.labels.add({ 0.f, "0.1" });
     peakQualitySlider.labels.add({ 1.f, "10.0" });
 
+    peakThresholdSlider.labels.add({ 0.f, "-60dB" });
+    peakThresholdSlider.labels.add({ 1.f, "0dB" });
+
+    peakRangeSlider.labels.add({ 0.f, "-24dB" });
+    peakRangeSlider.labels.add({ 1.f, "+24dB" });
+
     lowCutFreqSlider.labels.add({ 0.f, "20Hz" });
     lowCutFreqSlider.labels.add({ 1.f, "20kHz" });
 
@@ -465,11 +1127,22 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor(SimpleEQAudioProcesso
     highCutSlopeSlider.labels.add({ 0.f, "-24dB" });
     highCutSlopeSlider.labels.add({ 1.f, "+24dB" });
 
+    // The attachment picks the initial item by index, so the choices have to exist first.
+    if (auto* modeParam = dynamic_cast<juce::AudioParameterChoice*>(p.apvts.getParameter(PROCESSING_MODE_PARAM_NAME))) {
+        processingModeBox.addItemList(modeParam->choices, 1);
+    }
+
+    processingModeBoxAttachment = std::make_unique<APVTS::ComboBoxAttachment>(p.apvts, PROCESSING_MODE_PARAM_NAME, processingModeBox);
+
+    storeMorphAButton.onClick = [&p] { p.storeMorphEndpoint(0); };
+    storeMorphBButton.onClick = [&p] { p.storeMorphEndpoint(1); };
+
     for (auto *comp : getComps()) {
         addAndMakeVisible(comp);
     }
 
-    setSize (600, 480);
+    setWantsKeyboardFocus(true);
+    setSize (600, 692);
 }
 
 SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
@@ -482,10 +1155,25 @@ void SimpleEQAudioProcessorEditor::resized()
     auto bounds = getLocalBounds();
     float hRatio = 25.f / 100.f;
     auto responseArea = bounds.removeFromTop(bounds.getHeight() * hRatio);
+    bounds.removeFromTop(4);
+    auto spectrogramArea = bounds.removeFromTop(72);
 
+    levelMeterComponent.setBounds(responseArea.removeFromRight(76).getUnion(spectrogramArea.removeFromRight(76)));
     responseCurveComponent.setBounds(responseArea);
+    responseCurveComponent.getSpectrogram().setBounds(spectrogramArea.reduced(20, 0));
 
     bounds.removeFromTop(5);
+    auto controlStrip = bounds.removeFromTop(22);
+    processingModeBox.setBounds(controlStrip.withSizeKeepingCentre(140, 22));
+    peakDynamicButton.setBounds(controlStrip.removeFromLeft(controlStrip.getWidth() / 2 - 70).withSizeKeepingCentre(100, 22));
+    peakSidechainButton.setBounds(controlStrip.removeFromRight(controlStrip.getWidth() - 140).withSizeKeepingCentre(100, 22));
+
+    bounds.removeFromTop(4);
+    auto morphStrip = bounds.removeFromTop(22).reduced(10, 0);
+    storeMorphAButton.setBounds(morphStrip.removeFromLeft(70));
+    storeMorphBButton.setBounds(morphStrip.removeFromRight(70));
+    morphButton.setBounds(morphStrip.removeFromLeft(80).reduced(6, 0));
+    morphSlider.setBounds(morphStrip.reduced(6, 0));
 
     auto lowCutArea = bounds.removeFromLeft(bounds.getWidth() * 0.33);
     auto highCutArea = bounds.removeFromRight(bounds.getWidth() * 0.5);
@@ -495,9 +1183,32 @@ void SimpleEQAudioProcessorEditor::resized()
     highCutFreqSlider.setBounds(highCutArea.removeFromTop(highCutArea.getHeight() * 0.5));
     highCutSlopeSlider.setBounds(highCutArea);
 
-    peakFreqSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.33));
-    peakGainSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.5));
-    peakQualitySlider.setBounds(bounds);
+    peakFreqSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.25));
+    peakGainSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.33));
+    peakQualitySlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.5));
+    peakThresholdSlider.setBounds(bounds.removeFromLeft(bounds.getWidth() / 2));
+    peakRangeSlider.setBounds(bounds);
+}
+
+bool SimpleEQAudioProcessorEditor::keyPressed(const juce::KeyPress& key)
+{
+    // Cmd/Ctrl+Shift+T starts a trace; pressing it again writes it to the desktop.
+    if (key != juce::KeyPress('t', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0)) {
+        return false;
+    }
+
+    auto& recorder = TraceRecorder::getInstance();
+
+    if (TraceRecorder::isEnabled()) {
+        recorder.stop();
+
+        auto name = "SimpleEQ trace " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S") + ".json";
+        recorder.writeTraceAsync(juce::File::getSpecialLocation(juce::File::userDesktopDirectory).getChildFile(name));
+    } else {
+        recorder.start();
+    }
+
+    return true;
 }
 
 std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps()
@@ -507,10 +1218,21 @@ std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps()
         &peakFreqSlider,
         &peakGainSlider,
         &peakQualitySlider,
+        &peakThresholdSlider,
+        &peakRangeSlider,
         &lowCutFreqSlider,
         &highCutFreqSlider,
         &lowCutSlopeSlider,
         &highCutSlopeSlider,
-        &responseCurveComponent
+        &responseCurveComponent,
+        &responseCurveComponent.getSpectrogram(),
+        &levelMeterComponent,
+        &processingModeBox,
+        &peakDynamicButton,
+        &peakSidechainButton,
+        &storeMorphAButton,
+        &storeMorphBButton,
+        &morphButton,
+        &morphSlider
     };
 }
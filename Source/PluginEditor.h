@@ -2,6 +2,13 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "MultirateAnalyzer.h"
+#include "SpectrumSmoother.h"
+#include "AnalysisService.h"
+#include "RenderedImageCache.h"
+#include "AnalyzerGovernor.h"
+#include "SpectrogramComponent.h"
+#include "LevelMeterComponent.h"
 
 #define SLIDER_FILL_COLOR juce::Colour(97u, 18u, 167u)
 #define SLIDER_BORDER_COLOR juce::Colour(255u, 154u, 1u)
@@ -14,83 +21,128 @@ enum FFTOrder
     order8192 = 13
 };
 
+// Analyzes two real signals with one complex FFT: left goes into the real part, right into the
+// imaginary part, and the two spectra are separated afterwards using conjugate symmetry.
+// Mid and side are linear combinations of the separated spectra, so all four come out of one transform.
+// Each frame holds the four smoothed spectra followed by their four peak-hold traces.
 template<typename BlockType>
-struct FFTDataGenerator
+struct StereoFFTDataGenerator
 {
     public:
+        enum Spectrum
+        {
+            LeftSpectrum,
+            RightSpectrum,
+            MidSpectrum,
+            SideSpectrum,
+            NumSpectra
+        };
+
         void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData, const float negativeInfinity)
         {
-            const auto fftSize = getFFTSize();
+            TraceScope trace("FFT frame");
 
-            fftData.assign(fftData.size(), 0);
-            auto* readIndex = audioData.getReadPointer(0);
-            std::copy(readIndex, readIndex + fftSize, fftData.begin());
+            jassert(audioData.getNumChannels() >= 2);
+
+            const auto fftSize = getFFTSize();
+            const auto numBins = fftSize / 2;
 
-            window->multiplyWithWindowingTable(fftData.data(), fftSize);
-            forwardFFT->performFrequencyOnlyForwardTransform(fftData.data());
+            auto* left = audioData.getReadPointer(0);
+            auto* right = audioData.getReadPointer(1);
 
-            int numBins = (int)fftSize / 2;
+            const auto& window = *windowTable;
 
-            for (int i = 0; i < numBins; ++i) {
-                fftData[i] /= (float)numBins;
+            for (int i = 0; i < fftSize; ++i) {
+                timeData[i] = { left[i] * window[i], right[i] * window[i] };
             }
 
-            for (int i = 0; i < numBins; ++i) {
-                fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
+            forwardFFT->perform(timeData.data(), frequencyData.data(), false);
+
+            using Complex = juce::dsp::Complex<float>;
+            const auto scale = 0.5f / (float)numBins;
+            const Complex minusJ { 0.f, -1.f };
+
+            auto toDecibels = [negativeInfinity](const Complex& c)
+                {
+                    return juce::Decibels::gainToDecibels(std::abs(c), negativeInfinity);
+                };
+
+            for (int k = 0; k < numBins; ++k) {
+                auto z = frequencyData[k];
+                auto zMirrored = std::conj(frequencyData[(fftSize - k) & (fftSize - 1)]);
+
+                auto l = (z + zMirrored) * scale;
+                auto r = minusJ * (z - zMirrored) * scale;
+
+                fftData[LeftSpectrum * numBins + k] = toDecibels(l);
+                fftData[RightSpectrum * numBins + k] = toDecibels(r);
+                fftData[MidSpectrum * numBins + k] = toDecibels((l + r) * 0.5f);
+                fftData[SideSpectrum * numBins + k] = toDecibels((l - r) * 0.5f);
             }
 
+            const auto numValues = NumSpectra * numBins;
+            smoother.process(fftData.data(), fftData.data() + numValues, numValues);
+
             fftDataFifo.push(fftData);
         }
 
-        void changeOrder(FFTOrder newOrder)
+        void changeOrder(FFTOrder newOrder, AnalysisService& analysisService)
         {
             order = newOrder;
             auto fftSize = getFFTSize();
 
-            forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-            window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
+            forwardFFT = analysisService.getFFT(order);
+            windowTable = analysisService.getWindowTable(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
+
+            timeData.assign(fftSize, {});
+            frequencyData.assign(fftSize, {});
 
             fftData.clear();
-            fftData.resize(fftSize * 2, 0);
+            fftData.resize(2 * NumSpectra * getNumBins(), 0);
 
             fftDataFifo.prepare(fftData.size());
         }
 
+        void prepareSmoother(double sampleRate, float framesPerSecond, float negativeInfinity)
+        {
+            const auto numBins = getNumBins();
+            std::vector<float> binFrequencies((size_t)(NumSpectra * numBins));
+
+            for (size_t i = 0; i < binFrequencies.size(); ++i) {
+                binFrequencies[i] = float(int(i) % numBins * sampleRate / getFFTSize());
+            }
+
+            smoother.prepare(binFrequencies, framesPerSecond, negativeInfinity);
+        }
+
+        SpectrumSmoother& getSmoother() { return smoother; }
+
         int getFFTSize() const { return 1 << order; }
+        int getNumBins() const { return getFFTSize() / 2; }
         int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
         bool getFFTData(BlockType& fftData) { return fftDataFifo.pull(fftData); }
     private:
         FFTOrder order;
         BlockType fftData;
-        std::unique_ptr<juce::dsp::FFT> forwardFFT;
-        std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+        std::shared_ptr<const std::vector<float>> windowTable;
+        std::vector<juce::dsp::Complex<float>> timeData, frequencyData;
+        std::shared_ptr<const juce::dsp::FFT> forwardFFT;
+        SpectrumSmoother smoother;
 
         Fifo<BlockType> fftDataFifo;
 };
 
-struct LookAndFeel : juce::LookAndFeel_V4
-{
-    void drawRotarySlider(
-        juce::Graphics& g,
-        int x, int y, int width, int height,
-        float sliderPosProportional,
-        float rotaryStartAngle,
-        float rotaryEndAngle,
-        juce::Slider& slider) override;
-};
-
+// A repaint only blits the cached static artwork and fills the rotated pointer and the value box;
+// the value text is formatted when the value changes, not on every repaint.
 struct RotarySliderWithLabels : juce::Slider
 {
     RotarySliderWithLabels(juce::RangedAudioParameter& rap, const juce::String& unitSuffix)
     : juce::Slider(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag, juce::Slider::TextEntryBoxPosition::NoTextBox),
-    param(&rap), suffix(unitSuffix)
-    {
-        setLookAndFeel(&lnf);
-    }
-
-    ~RotarySliderWithLabels()
+    choiceParam(dynamic_cast<juce::AudioParameterChoice*>(&rap)),
+    floatParam(dynamic_cast<juce::AudioParameterFloat*>(&rap)),
+    suffix(unitSuffix)
     {
-        setLookAndFeel(nullptr);
+        jassert(choiceParam != nullptr || floatParam != nullptr);
     }
 
     struct LabelPos
@@ -102,41 +154,146 @@ struct RotarySliderWithLabels : juce::Slider
     juce::Array<LabelPos> labels;
 
     void paint(juce::Graphics& g) override;
+    void resized() override;
+    void valueChanged() override;
     juce::Rectangle<int> getSliderBounds() const;
     int getTextHeight() const { return 12; }
     juce::String getDisplayString() const;
 
     private:
-        LookAndFeel lnf;
-
-        juce::RangedAudioParameter* param;
+        juce::AudioParameterChoice* choiceParam;
+        juce::AudioParameterFloat* floatParam;
         juce::String suffix;
+
+        // Body, border and range labels, rendered at the physical pixel scale and shared by
+        // every knob with the same size and labels.
+        juce::SharedResourcePointer<RenderedImageCache> artworkCache;
+        juce::Image artwork;
+        float artworkScale = 0;
+        juce::Path pointer;
+
+        juce::String displayString;
+        int displayStringWidth = 0;
+        bool displayStringDirty = true;
+
+        juce::String getArtworkKey(float scale) const;
+        juce::Image renderArtwork(float scale) const;
 };
 
-struct ResponseCurveComponent : juce::Component, juce::AudioProcessorParameter::Listener, juce::Timer
+struct ResponseCurveComponent : juce::Component, AnalysisService::Client
 {
     public:
         ResponseCurveComponent(SimpleEQAudioProcessor&);
         ~ResponseCurveComponent();
 
-        void parameterValueChanged(int parameterIndex, float newValue) override;
-        void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override {};
-        void timerCallback() override;
+        void runAnalysis() override;
+        void handleAnalysisResults() override;
 
         void paint(juce::Graphics& g) override;
         void resized() override;
+        void mouseDown(const juce::MouseEvent& event) override;
+
+        // PrePost analyzes the dry input only and draws the output as the input plus the
+        // filter's response, which holds because the EQ is linear.
+        enum class AnalyzerView
+        {
+            LeftRight,
+            MidSide,
+            PrePost
+        };
+
+        enum class AnalyzerMode
+        {
+            FFT,
+            ConstantQ
+        };
+
+        void setAnalyzerView(AnalyzerView newView);
+        void setAnalyzerMode(AnalyzerMode newMode);
+        void setSmootherSettings(const SpectrumSmoother::Settings& newSettings);
+
+        // Also analyzes the real output in PrePost, to check the derived curve against it.
+        void setMeasurePost(bool shouldMeasure);
+
+        // Fed with every analyzer frame; the editor places it.
+        SpectrogramComponent& getSpectrogram() { return spectrogram; }
 
     private:
-        MonoChain monoChain;
+        using StereoGenerator = StereoFFTDataGenerator<std::vector<float>>;
+
+        juce::SharedResourcePointer<AnalysisService> analysisService;
+        juce::CriticalSection analyzerLock;
+        bool analyzerStarted = false, analyzerStartPending = false;
+
+        AnalyzerGovernor governor;
+        int analyzerOrder = 0;
+        int analysisOverlap = 2;
+        int analysisFrameDivisor = 1;
+        int analysisSlot = 0;
+        std::atomic<juce::int64> analysisTicks { 0 };
+        juce::int64 messageThreadTicks = 0;
+        juce::int64 lastGovernorTicks = 0;
+
+        ChainCoefficients::Ptr chainCoefficients;
+        juce::SharedResourcePointer<RenderedImageCache> imageCache;
         juce::Image background;
-        juce::Atomic<bool> parametersChanged{ false };
+        float backgroundScale = 0;
         SimpleEQAudioProcessor& audioProcessor;
-        SingleChannelSampleInfo<SimpleEQAudioProcessor::BlockType>* leftChannelFifo;
-        juce::AudioBuffer<float> monoBuffer;
-        FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
-
-
+        BroadcastRing<float>::Reader analyzerReader, inputReader;
+        bool inputFeedAcquired = false;
+        juce::AudioBuffer<float> incomingBuffer;
+        juce::AudioBuffer<float> stereoBuffer;
+        StereoGenerator stereoFFTDataGenerator;
+
+        MultirateSpectrumAnalyzer constantQAnalyzer;
+        double constantQSampleRate = 0;
+        std::vector<float> midScratch;
+
+        AnalyzerView analyzerView = AnalyzerView::LeftRight;
+        AnalyzerMode analyzerMode = AnalyzerMode::FFT;
+        SpectrumSmoother::Settings smootherSettings;
+        double smootherSampleRate = 0;
+        std::vector<float> spectrumFrame;
+        juce::Path analyzerPaths[2], peakPaths[2];
+
+        // Filter response per FFT bin in dB, for the derived post curve.
+        std::vector<float> binResponse, derivedSpectrum;
+        ChainCoefficients::Ptr binResponseCoefficients;
+        ProcessingMode binResponseMode = ProcessingMode::Stereo;
+
+        bool measurePost = false;
+        BroadcastRing<float>::Reader postReader;
+        juce::AudioBuffer<float> postBuffer;
+        StereoGenerator postGenerator;
+        std::vector<float> postFrame;
+        juce::Path measuredPostPath;
+
+        SpectrogramComponent spectrogram { analyzerNegativeInfinity, 0.f };
+
+        static constexpr float analyzerNegativeInfinity = -48.f;
+        static constexpr int constantQChunkSize = 512;
+
+        void startAnalyzer();
+        void applyAnalyzerQuality();
+        void updateGovernor();
+        juce::Image renderBackground(float scale);
         void updateChain();
+        void pullAudioIntoAnalyzer();
+        void pullFeed(BroadcastRing<float>& feed, BroadcastRing<float>::Reader& reader, juce::AudioBuffer<float>& window,
+                      StereoGenerator& generator, int hop);
+        bool analysesInput() const { return analyzerMode == AnalyzerMode::FFT && analyzerView == AnalyzerView::PrePost; }
+        void updateAnalyzerSource();
+        void preparePostGenerator();
+        void updateBinResponse();
+        const float* deriveOutputSpectrum(const float* decibels, int numBins);
+        void updateAnalyzerPaths();
+        void pushSpectrogramFrame();
+        void rebuildAnalyzerPaths();
+        juce::Path makeAnalyzerPath(const float* decibels, int numBins, juce::Rectangle<float> area) const;
+        juce::Path makeConstantQPath(const float* decibels, int numPoints, juce::Rectangle<float> area) const;
+        void prepareConstantQAnalyzer();
+        void prepareStereoSmoother();
+        void showAnalyzerMenu();
         juce::Rectangle<int> getRenderArea();
         juce::Rectangle<int> getAnalisysArea();
 
@@ -149,20 +306,33 @@ class SimpleEQAudioProcessorEditor : public juce::AudioProcessorEditor
         ~SimpleEQAudioProcessorEditor() override;
 
         void resized() override;
+        bool keyPressed(const juce::KeyPress& key) override;
 
     private:
         RotarySliderWithLabels peakFreqSlider, peakGainSlider, peakQualitySlider;
+        RotarySliderWithLabels peakThresholdSlider, peakRangeSlider;
         RotarySliderWithLabels lowCutFreqSlider, highCutFreqSlider;
         RotarySliderWithLabels lowCutSlopeSlider, highCutSlopeSlider;
 
         ResponseCurveComponent responseCurveComponent;
+        LevelMeterComponent levelMeterComponent;
+        juce::ComboBox processingModeBox;
+        juce::ToggleButton peakDynamicButton { "Dynamic" }, peakSidechainButton { "Sidechain" };
+        juce::TextButton storeMorphAButton { "Store A" }, storeMorphBButton { "Store B" };
+        juce::ToggleButton morphButton { "Morph" };
+        juce::Slider morphSlider { juce::Slider::LinearHorizontal, juce::Slider::NoTextBox };
 
         using APVTS = juce::AudioProcessorValueTreeState;
         using Attachment = APVTS::SliderAttachment;
 
         Attachment peakFreqSliderAttachment, peakGainSliderAttachment, peakQualitySliderAttachment;
+        Attachment peakThresholdSliderAttachment, peakRangeSliderAttachment;
         Attachment lowCutFreqSliderAttachment, highCutFreqSliderAttachment;
         Attachment lowCutSlopeSliderAttachment, highCutSlopeSliderAttachment;
+        std::unique_ptr<APVTS::ComboBoxAttachment> processingModeBoxAttachment;
+        APVTS::ButtonAttachment peakDynamicButtonAttachment, peakSidechainButtonAttachment;
+        APVTS::ButtonAttachment morphButtonAttachment;
+        Attachment morphSliderAttachment;
 
         std::vector<juce::Component*> getComps();
 
@@ -8,12 +8,20 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        )
 #endif
 {
+    morphSlots[0] = morphSlots[1] = getChainSettings(apvts);
+
+    liveCoefficients = new ChainCoefficients();
+
+    for (auto& copy : publishedCopies) {
+        copy = new ChainCoefficients();
+    }
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
@@ -60,21 +68,42 @@ double SimpleEQAudioProcessor::getTailLengthSeconds() const
 
 int SimpleEQAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+    return juce::jmax(1, presetBank->size());   // NB: some hosts don't cope very well if you tell them there are 0 programs,
                 // so this should be at least 1, even if you're not really implementing programs.
 }
 
 int SimpleEQAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram;
 }
 
 void SimpleEQAudioProcessor::setCurrentProgram (int index)
 {
+    if (!juce::isPositiveAndBelow(index, presetBank->size())) {
+        return;
+    }
+
+    currentProgram = index;
+
+    // The audio thread swaps in the precomputed coefficients and crossfades to them. The parameters
+    // are moved afterwards, with redesigns held off so half-updated values are never designed.
+    programChangeInProgress.store(true);
+
+    if (index < presetCoefficients.size()) {
+        pendingProgram.store(index);
+    }
+
+    applyPresetValues((*presetBank)[index]);
+
+    programChangeInProgress.store(false);
 }
 
 const juce::String SimpleEQAudioProcessor::getProgramName (int index)
 {
+    if (juce::isPositiveAndBelow(index, presetBank->size())) {
+        return (*presetBank)[index].name;
+    }
+
     return {};
 }
 
@@ -85,25 +114,68 @@ void SimpleEQAudioProcessor::changeProgramName (int index, const juce::String& n
 //==============================================================================
 void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    juce::dsp::ProcessSpec spec;
+    // Both engines' sections in one block.
+    stateArena.allocate(engines.size() * FilterEngine::getArenaSize());
+
+    for (auto& engine : engines) {
+        engine.prepare(stateArena);
+    }
 
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
-    spec.sampleRate = sampleRate;
+    scheduler.prepare(controlQuantum, samplesPerBlock);
+    loadMeasurer.reset(sampleRate, samplesPerBlock);
+    inputMeter.prepare(sampleRate);
+    outputMeter.prepare(sampleRate);
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    crossfadeLength = juce::jmax(1, juce::roundToInt(sampleRate * crossfadeMs / 1000.0));
+    crossfadeRemaining = 0;
+    crossfadeBuffer.setSize(2, scheduler.getMaxSubBlockSize());
+    crossfadeBufferDouble.setSize(isUsingDoublePrecision() ? 2 : 0, scheduler.getMaxSubBlockSize());
 
-    updateFilters();
+    dspStateBytes.store(stateArena.getSize()
+                      + (size_t)(crossfadeBuffer.getNumChannels() * crossfadeBuffer.getNumSamples()) * sizeof(float)
+                      + (size_t)(crossfadeBufferDouble.getNumChannels() * crossfadeBufferDouble.getNumSamples()) * sizeof(double));
+
+    pendingProgram.store(-1);
+    preparePresetCoefficients(sampleRate);
+
+    morphAmount.reset(sampleRate / controlQuantum, 0.05);
+    morphAmount.setCurrentAndTargetValue(apvts.getRawParameterValue(MORPH_AMOUNT_PARAM_NAME)->load());
+    morphApplied = false;
+    updateMorphEndpoints(sampleRate);
+    takeMorphEndpoints();
+    dynamicPeak.prepare(sampleRate, controlQuantum);
+    dynamicPeakGain.store(0);
+    peakOffset = 0;
+    peakRampRemaining = 0;
+
+    activeBackend = requestedBackend.load();
+    activePrecision = requestedPrecision.load();
+
+    for (auto& engine : engines) {
+        engine.setPrecision(activePrecision);
+    }
 
-    leftChannelFifo.prepare(samplesPerBlock);
-    rightChannelFifo.prepare(samplesPerBlock);
+    resetBackend();
+
+    currentCoefficients = nullptr;
+    updateFilters();
 }
 
 void SimpleEQAudioProcessor::releaseResources()
 {
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
+    // Only the block-sized scratch; prepareToPlay sizes it again.
+    crossfadeBuffer.setSize(0, 0);
+    crossfadeBufferDouble.setSize(0, 0);
+    dspStateBytes.store(stateArena.getSize());
+}
+
+SimpleEQAudioProcessor::MemoryUsage SimpleEQAudioProcessor::getMemoryUsage() const
+{
+    MemoryUsage usage;
+    usage.dspState = dspStateBytes.load(std::memory_order_relaxed);
+    usage.analyzerFeeds = analyzerFeed.getAllocatedBytes() + inputFeed.getAllocatedBytes();
+
+    return usage;
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -125,6 +197,16 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // The optional side-chain only feeds the dynamic peak detector.
+    if (layouts.inputBuses.size() > 1) {
+        auto sidechain = layouts.getChannelSet(true, 1);
+
+        if (!sidechain.isDisabled()
+         && sidechain != juce::AudioChannelSet::mono()
+         && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
    #endif
 
     return true;
@@ -132,8 +214,23 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 }
 #endif
 
-void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
 {
+    processAudio(buffer);
+}
+
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processAudio(buffer);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processAudio(juce::AudioBuffer<SampleType>& buffer)
+{
+    TraceRecorder::nameCurrentThread("Audio");
+    TraceScope trace("processBlock");
+    juce::AudioProcessLoadMeasurer::ScopedTimer loadTimer(loadMeasurer, buffer.getNumSamples());
+
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -147,21 +244,295 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    updateFilters();
+    lastProcessTime.store(juce::Time::getMillisecondCounter(), std::memory_order_relaxed);
+
+    auto requested = requestedBackend.load(std::memory_order_relaxed);
+    if (requested != activeBackend) {
+        activeBackend = requested;
+        resetBackend();
+    }
+
+    auto precision = requestedPrecision.load(std::memory_order_relaxed);
+    if (precision != activePrecision) {
+        activePrecision = precision;
+        applyPrecision();
+    }
+
+    processingMode = static_cast<ProcessingMode>(apvts.getRawParameterValue(PROCESSING_MODE_PARAM_NAME)->load());
+
+    auto program = pendingProgram.exchange(-1);
+    if (program >= 0) {
+        startProgramChange(program);
+    }
+
+    takeMorphEndpoints();
+    morphEnabled = apvts.getRawParameterValue(MORPH_PARAM_NAME)->load() > 0.5f && morph.hasEndpoints();
+
+    if (!morphEnabled) {
+        morphAmount.setCurrentAndTargetValue(apvts.getRawParameterValue(MORPH_AMOUNT_PARAM_NAME)->load());
+    }
+
+    auto mainBuffer = getBusBuffer(buffer, false, 0);
+    auto numSamples = mainBuffer.getNumSamples();
+
+    inputMeter.measure(mainBuffer, numSamples);
+
+    inputFeed.push(mainBuffer, numSamples);
+
+    // The detector reads its whole block up front, while the main bus still holds the dry input.
+    dynamicSettings = getDynamicPeakSettings(apvts);
+
+    if (dynamicSettings.enabled) {
+        auto* sidechainBus = getBus(true, 1);
+
+        if (dynamicSettings.useSidechain && sidechainBus != nullptr && sidechainBus->isEnabled()) {
+            dynamicPeak.analyse(getBusBuffer(buffer, true, 1), numSamples, scheduler.getSamplesUntilTick());
+        } else {
+            dynamicPeak.analyse(mainBuffer, numSamples, scheduler.getSamplesUntilTick());
+        }
+    }
+
+    scheduler.process(
+        numSamples,
+        [this](int position) { return controlTick(position); },
+        [this] { applyControlUpdate(); },
+        [this, &mainBuffer](int startSample, int subBlockSize) { renderRun(mainBuffer, startSample, subBlockSize); }
+    );
+
+    publishCoefficients();
+
+    outputMeter.measure(mainBuffer, numSamples);
+    analyzerFeed.push(mainBuffer, numSamples);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::renderRun(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples)
+{
+    // While the peak gain ramps, the run is cut at each ramp step. The band is redesigned only as a
+    // step is entered; a run that ends inside a step leaves its coefficients for the rest of it.
+    while (peakRampRemaining > 0 && numSamples > 0) {
+        if (peakRampRemaining % peakRampStep == 0) {
+            enterPeakRampStep();
+        }
+
+        auto num = juce::jmin(numSamples, (peakRampRemaining - 1) % peakRampStep + 1);
+
+        processSubBlock(buffer, startSample, num);
+
+        peakRampRemaining -= num;
+        startSample += num;
+        numSamples -= num;
+    }
+
+    if (numSamples > 0) {
+        processSubBlock(buffer, startSample, numSamples);
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processSubBlock(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples)
+{
+    auto& engine = engines[(size_t)activeEngine];
+
+    if (crossfadeRemaining <= 0) {
+        renderEngine(engine, buffer, startSample, numSamples);
+        return;
+    }
+
+    // A program change is fading in: the outgoing engine renders a copy of the input and the two are
+    // mixed with a linear ramp.
+    auto& fadeBuffer = [this]() -> auto&
+        {
+            if constexpr (std::is_same_v<SampleType, double>) {
+                return crossfadeBufferDouble;
+            } else {
+                return crossfadeBuffer;
+            }
+        }();
+
+    auto numChannels = juce::jmin(2, buffer.getNumChannels(), fadeBuffer.getNumChannels());
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        fadeBuffer.copyFrom(channel, 0, buffer, channel, startSample, numSamples);
+    }
+
+    renderEngine(engine, buffer, startSample, numSamples);
+    renderEngine(engines[(size_t)(1 - activeEngine)], fadeBuffer, 0, numSamples);
+
+    auto position = crossfadeLength - crossfadeRemaining;
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        auto* incoming = buffer.getWritePointer(channel, startSample);
+        auto* outgoing = fadeBuffer.getReadPointer(channel);
+
+        for (int i = 0; i < numSamples; ++i) {
+            auto gain = juce::jmin((SampleType)1, (SampleType)(position + i + 1) / (SampleType)crossfadeLength);
+            incoming[i] = outgoing[i] + gain * (incoming[i] - outgoing[i]);
+        }
+    }
+
+    crossfadeRemaining = juce::jmax(0, crossfadeRemaining - numSamples);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::renderEngine(FilterEngine& engine, juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples)
+{
+    using FVO = juce::FloatVectorOperations;
+
+    auto numChannels = juce::jmin(2, buffer.getNumChannels());
+
+    if (numChannels < 2 || processingMode == ProcessingMode::Stereo) {
+        for (int channel = 0; channel < numChannels; ++channel) {
+            engine.process(activeBackend, channel, buffer.getWritePointer(channel, startSample), numSamples);
+        }
+
+        return;
+    }
+
+    auto* left = buffer.getWritePointer(0, startSample);
+    auto* right = buffer.getWritePointer(1, startSample);
+
+    // Encode in place: left becomes mid = (L + R) / 2, right becomes side = (L - R) / 2.
+    FVO::add(left, right, numSamples);
+    FVO::multiply(right, -2.f, numSamples);
+    FVO::add(right, left, numSamples);
+    FVO::multiply(left, 0.5f, numSamples);
+    FVO::multiply(right, 0.5f, numSamples);
+
+    // The left chain carries mid and the right chain carries side; a path that is left alone
+    // isn't run at all.
+    if (processingMode != ProcessingMode::SideOnly) {
+        engine.process(activeBackend, 0, left, numSamples);
+    }
+
+    if (processingMode != ProcessingMode::MidOnly) {
+        engine.process(activeBackend, 1, right, numSamples);
+    }
+
+    // Decode in place: L = M + S, R = M - S.
+    FVO::add(left, right, numSamples);
+    FVO::multiply(right, -2.f, numSamples);
+    FVO::add(right, left, numSamples);
+}
+
+void SimpleEQAudioProcessor::setProcessingBackend(ProcessingBackend newBackend)
+{
+    requestedBackend.store(newBackend);
+}
+
+void SimpleEQAudioProcessor::resetBackend()
+{
+    // Each backend keeps its own filter state; the one taking over starts from silence.
+    for (auto& engine : engines) {
+        engine.reset();
+    }
+
+    crossfadeRemaining = 0;
+}
+
+void SimpleEQAudioProcessor::setPrecisionMode(PrecisionMode newPrecision)
+{
+    requestedPrecision.store(newPrecision);
+}
+
+void SimpleEQAudioProcessor::applyPrecision()
+{
+    // Bands move between the float and double cascades, so the active engine is rebuilt from the
+    // current snapshot; a morph reloads on its next tick and a live dynamic gain is laid over again.
+    for (auto& engine : engines) {
+        engine.setPrecision(activePrecision);
+    }
+
+    if (currentCoefficients != nullptr) {
+        engines[(size_t)activeEngine].setCoefficients(*currentCoefficients);
+
+        if (peakOffset != 0.f) {
+            applyDynamicPeakGain();
+        }
+    }
+
+    morphApplied = false;
+    resetBackend();
+}
+
+void SimpleEQAudioProcessor::startProgramChange(int program)
+{
+    if (!juce::isPositiveAndBelow(program, presetCoefficients.size())) {
+        return;
+    }
+
+    auto* snapshot = presetCoefficients.getObjectPointerUnchecked(program);
+
+    if (currentCoefficients != nullptr && currentCoefficients->settings == snapshot->settings) {
+        return;
+    }
 
-    juce::dsp::AudioBlock<float> block(buffer);
+    // The idle engine takes the new coefficients from silence and fades in over the current one.
+    activeEngine = 1 - activeEngine;
 
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    auto& engine = engines[(size_t)activeEngine];
+    engine.reset();
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    currentCoefficients = snapshot;
+    liveSettings = currentCoefficients->settings;
+    morphApplied = false;
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    engine.setCoefficients(*currentCoefficients);
+    dynamicPeak.setBand(liveSettings.peakFreq, liveSettings.peakQuality);
 
-    leftChannelFifo.update(buffer);
-    rightChannelFifo.update(buffer);
+    if (peakOffset != 0.f) {
+        applyDynamicPeakGain();
+    }
+
+    crossfadeRemaining = crossfadeLength;
+    publishPending = true;
+}
+
+float SimpleEQAudioProcessor::getPresetValue(const Preset& preset, const juce::String& parameterID)
+{
+    // Goes through the same normalised value the parameter will hold, so a preset's ChainSettings
+    // compare equal to the ones read back from the parameters once it has been applied.
+    auto* parameter = apvts.getParameter(parameterID);
+    jassert(parameter != nullptr);
+
+    auto* value = preset.find(parameterID);
+    auto normalised = value != nullptr ? parameter->convertTo0to1(value->value) : parameter->getDefaultValue();
+
+    return parameter->convertFrom0to1(normalised);
+}
+
+ChainSettings SimpleEQAudioProcessor::getPresetChainSettings(const Preset& preset)
+{
+    ChainSettings settings;
+
+    settings.lowCutFreq = getPresetValue(preset, LOW_CUT_FREQ_PARAM_NAME);
+    settings.highCutFreq = getPresetValue(preset, HIGH_CUT_FREQ_PARAM_NAME);
+    settings.peakFreq = getPresetValue(preset, PEAK_FREQ_PARAM_NAME);
+    settings.peakGainInDecibels = getPresetValue(preset, PEAK_GAIN_PARAM_NAME);
+    settings.peakQuality = getPresetValue(preset, PEAK_QUALITY_PARAM_NAME);
+    settings.lowCutSlope = static_cast<Slope>(getPresetValue(preset, LOW_CUT_SLOPE_PARAM_NAME));
+    settings.highCutSlope = static_cast<Slope>(getPresetValue(preset, HIGH_CUT_SLOPE_PARAM_NAME));
+
+    return settings;
+}
+
+void SimpleEQAudioProcessor::applyPresetValues(const Preset& preset)
+{
+    for (auto* parameter : getParameters()) {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter)) {
+            auto* value = preset.find(ranged->paramID);
+            ranged->setValueNotifyingHost(value != nullptr ? ranged->convertTo0to1(value->value) : ranged->getDefaultValue());
+        }
+    }
+}
+
+void SimpleEQAudioProcessor::preparePresetCoefficients(double sampleRate)
+{
+    presetCoefficients.clear();
+
+    for (int i = 0; i < presetBank->size(); ++i) {
+        presetCoefficients.add(makeChainCoefficients(getPresetChainSettings((*presetBank)[i]), sampleRate));
+    }
 }
 
 //==============================================================================
@@ -178,19 +549,78 @@ juce::AudioProcessorEditor* SimpleEQAudioProcessor::createEditor()
 //==============================================================================
 void SimpleEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
+    Preset state;
+    state.name = getProgramName(currentProgram);
+
+    for (auto* parameter : getParameters()) {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter)) {
+            state.values.push_back({ ranged->paramID, ranged->convertFrom0to1(ranged->getValue()) });
+        }
+    }
+
+    writeMorphEndpoint(state, 0, morphSlots[0]);
+    writeMorphEndpoint(state, 1, morphSlots[1]);
+
     juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
+    writePreset(mos, state, currentProgram);
 }
 
 void SimpleEQAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
+    juce::MemoryInputStream input(data, (size_t)sizeInBytes, false);
+    Preset state;
+    int program = 0;
+
+    if (readPreset(input, state, program)) {
+        if (juce::isPositiveAndBelow(program, presetBank->size())) {
+            currentProgram = program;
+        }
+
+        applyPresetValues(state);
+
+        morphSlots[0] = readMorphEndpoint(state, 0, morphSlots[0]);
+        morphSlots[1] = readMorphEndpoint(state, 1, morphSlots[1]);
+        updateMorphEndpoints(getSampleRate());
+        return;
+    }
+
+    // Sessions saved before the binary format hold the parameter ValueTree.
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     if (tree.isValid()) {
         apvts.replaceState(tree);
-        updateFilters();
     }
 }
 
+ChainCoefficients::Ptr SimpleEQAudioProcessor::getCoefficientsForDisplay()
+{
+    static constexpr juce::uint32 idleTimeoutMs = 200;
+
+    auto latest = coefficientPublisher.getLatest();
+    auto sinceLastBlock = juce::Time::getMillisecondCounter() - lastProcessTime.load(std::memory_order_relaxed);
+
+    // Morphing moves the filters without publishing, so the curve is designed here from the morph settings.
+    auto morphing = apvts.getRawParameterValue(MORPH_PARAM_NAME)->load() > 0.5f;
+
+    if (latest != nullptr && sinceLastBlock < idleTimeoutMs && !morphing) {
+        return latest;
+    }
+
+    // Nothing is being processed (or the published set is behind the morph), so design a
+    // display-only set instead, so the curve still follows the controls.
+    auto chainSettings = getEffectiveChainSettings();
+    auto sampleRate = getSampleRate();
+
+    if (sampleRate <= 0 || (latest != nullptr && latest->settings == chainSettings && latest->sampleRate == sampleRate)) {
+        return latest;
+    }
+
+    if (idleCoefficients == nullptr || idleCoefficients->settings != chainSettings || idleCoefficients->sampleRate != sampleRate) {
+        idleCoefficients = makeChainCoefficients(chainSettings, sampleRate);
+    }
+
+    return idleCoefficients;
+}
+
 ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
 {
     ChainSettings settings;
@@ -206,52 +636,595 @@ ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
     return settings;
 }
 
-void updateCoefficients(Coefficients& old, const Coefficients& replacement)
+void toBiquad(const juce::dsp::IIR::Coefficients<float>& coefficients, float* biquad)
 {
-    *old = *replacement;
+    // JUCE stores normalised coefficients as b0..bN, a1..aN; first-order sections are padded to a biquad.
+    const auto* raw = coefficients.coefficients.begin();
+    const auto order = (int)coefficients.getFilterOrder();
+
+    jassert(order == 1 || order == 2);
+
+    biquad[0] = raw[0];
+    biquad[1] = raw[1];
+    biquad[2] = order == 2 ? raw[2] : 0.f;
+    biquad[3] = order == 2 ? raw[3] : raw[2];
+    biquad[4] = order == 2 ? raw[4] : 0.f;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+// Float arithmetic in the order JUCE's designers use, so a set designed here is identical to theirs.
+static void designPeakSection(juce::dsp::IIR::Coefficients<float>& coefficients, double sampleRate, float frequency, float quality, float gainInDecibels)
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-        sampleRate,
-        chainSettings.peakFreq,
-        chainSettings.peakQuality,
-        juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels)
-    );
+    auto A = juce::jmax(0.f, std::sqrt(juce::Decibels::decibelsToGain(gainInDecibels)));
+    auto omega = (2 * juce::MathConstants<float>::pi * juce::jmax(frequency, 2.f)) / (float)sampleRate;
+    auto alpha = std::sin(omega) / (quality * 2);
+    auto c2 = -2 * std::cos(omega);
+    auto alphaTimesA = alpha * A;
+    auto alphaOverA = alpha / A;
+    auto a0inv = 1 / (1 + alphaOverA);
+    auto* raw = coefficients.getRawCoefficients();
+
+    raw[0] = (1 + alphaTimesA) * a0inv;
+    raw[1] = c2 * a0inv;
+    raw[2] = (1 - alphaTimesA) * a0inv;
+    raw[3] = c2 * a0inv;
+    raw[4] = (1 - alphaOverA) * a0inv;
 }
 
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
+static void designButterworthSection(juce::dsp::IIR::Coefficients<float>& coefficients, double sampleRate, float frequency, int order, int section, bool highPass)
 {
-    Coefficients peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+    auto Q = (float)(1.0 / (2.0 * std::cos((section * 2.0 + 1.0) * juce::MathConstants<double>::pi / (order * 2.0))));
+    auto k = std::tan(juce::MathConstants<float>::pi * frequency / (float)sampleRate);
+    auto n = highPass ? k : 1 / k;
+    auto nSquared = n * n;
+    auto invQ = 1 / Q;
+    auto c1 = 1 / (1 + invQ * n + nSquared);
+    auto* raw = coefficients.getRawCoefficients();
 
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    raw[0] = c1;
+    raw[1] = highPass ? c1 * -2 : c1 * 2;
+    raw[2] = c1;
+    raw[3] = highPass ? c1 * 2 * (nSquared - 1) : c1 * 2 * (1 - nSquared);
+    raw[4] = c1 * (1 - invQ * n + nSquared);
 }
 
-void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings)
+ChainCoefficients::ChainCoefficients()
+    : peak(new juce::dsp::IIR::Coefficients<float>(1.f, 0.f, 0.f, 1.f, 0.f, 0.f))
 {
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
+    for (int i = 0; i < maxCutSections; ++i) {
+        lowCutSections.add(new juce::dsp::IIR::Coefficients<float>(1.f, 0.f, 0.f, 1.f, 0.f, 0.f));
+        highCutSections.add(new juce::dsp::IIR::Coefficients<float>(1.f, 0.f, 0.f, 1.f, 0.f, 0.f));
+    }
 
-    updateCutFilter(leftChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(rightChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
+    lowCut.ensureStorageAllocated(maxCutSections);
+    highCut.ensureStorageAllocated(maxCutSections);
 }
 
-void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings)
+void ChainCoefficients::useSections(CutCoefficients& cut, const CutCoefficients& sections, int numSections)
 {
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+    jassert(numSections <= maxCutSections);
+
+    // clearQuick keeps the storage, and the sections themselves are still held by the spare set.
+    cut.clearQuick();
 
-    updateCutFilter(leftChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+    for (int i = 0; i < numSections; ++i) {
+        cut.add(sections.getObjectPointerUnchecked(i));
+    }
+}
+
+void ChainCoefficients::design(const ChainSettings& chainSettings, double newSampleRate)
+{
+    settings = chainSettings;
+    sampleRate = newSampleRate;
+
+    designPeakSection(*peak, sampleRate, settings.peakFreq, settings.peakQuality, settings.peakGainInDecibels);
+
+    auto lowCutOrder = 2 * ((int)settings.lowCutSlope + 1);
+    auto highCutOrder = 2 * ((int)settings.highCutSlope + 1);
+
+    useSections(lowCut, lowCutSections, lowCutOrder / 2);
+    useSections(highCut, highCutSections, highCutOrder / 2);
+
+    for (int i = 0; i < lowCut.size(); ++i) {
+        designButterworthSection(*lowCut.getObjectPointerUnchecked(i), sampleRate, settings.lowCutFreq, lowCutOrder, i, true);
+    }
+
+    for (int i = 0; i < highCut.size(); ++i) {
+        designButterworthSection(*highCut.getObjectPointerUnchecked(i), sampleRate, settings.highCutFreq, highCutOrder, i, false);
+    }
+}
+
+void ChainCoefficients::copyFrom(const ChainCoefficients& other)
+{
+    // Element-wise, since assigning the coefficient Arrays would allocate.
+    auto copy = [](const juce::dsp::IIR::Coefficients<float>& source, juce::dsp::IIR::Coefficients<float>& destination)
+        {
+            jassert(source.coefficients.size() == destination.coefficients.size());
+            std::copy(source.coefficients.begin(), source.coefficients.end(), destination.coefficients.begin());
+        };
+
+    settings = other.settings;
+    sampleRate = other.sampleRate;
+
+    copy(*other.peak, *peak);
+
+    useSections(lowCut, lowCutSections, other.lowCut.size());
+    useSections(highCut, highCutSections, other.highCut.size());
+
+    for (int i = 0; i < lowCut.size(); ++i) {
+        copy(*other.lowCut.getObjectPointerUnchecked(i), *lowCut.getObjectPointerUnchecked(i));
+    }
+
+    for (int i = 0; i < highCut.size(); ++i) {
+        copy(*other.highCut.getObjectPointerUnchecked(i), *highCut.getObjectPointerUnchecked(i));
+    }
+}
+
+double ChainCoefficients::getMagnitudeForFrequency(double frequency) const
+{
+    double mag = peak->getMagnitudeForFrequency(frequency, sampleRate);
+
+    for (auto* section : lowCut) {
+        mag *= section->getMagnitudeForFrequency(frequency, sampleRate);
+    }
+
+    for (auto* section : highCut) {
+        mag *= section->getMagnitudeForFrequency(frequency, sampleRate);
+    }
+
+    return mag;
+}
+
+ChainCoefficients::Ptr makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate)
+{
+    ChainCoefficients::Ptr chainCoefficients = new ChainCoefficients();
+    chainCoefficients->design(chainSettings, sampleRate);
+
+    return chainCoefficients;
+}
+
+CoefficientPublisher::CoefficientPublisher()
+{
+    startTimer(ReclaimIntervalMs);
+}
+
+CoefficientPublisher::~CoefficientPublisher()
+{
+    stopTimer();
+    reclaim();
+
+    if (auto* previous = latest.exchange(nullptr)) {
+        previous->decReferenceCount();
+    }
+}
+
+bool CoefficientPublisher::publish(const ChainCoefficients::Ptr& snapshot)
+{
+    jassert(snapshot != nullptr);
+
+    if (retiredFifo.getFreeSpace() == 0) {
+        return false;
+    }
+
+    snapshot->incReferenceCount();
+
+    if (auto* previous = latest.exchange(snapshot.get(), std::memory_order_acq_rel)) {
+        auto write = retiredFifo.write(1);
+        retired[(size_t)write.startIndex1] = previous;
+    }
+
+    return true;
+}
+
+ChainCoefficients::Ptr CoefficientPublisher::getLatest() const
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    return ChainCoefficients::Ptr(latest.load(std::memory_order_acquire));
+}
+
+void CoefficientPublisher::timerCallback()
+{
+    reclaim();
+}
+
+void CoefficientPublisher::reclaim()
+{
+    auto read = retiredFifo.read(retiredFifo.getNumReady());
+
+    read.forEach([this](int index)
+        {
+            retired[(size_t)index]->decReferenceCount();
+            retired[(size_t)index] = nullptr;
+        });
+}
+
+void FilterEngine::prepare(DSPStateArena& arena)
+{
+    using DoubleSection = BiquadCascade<double>::Section;
+    using FloatSection = BiquadCascade<float>::Section;
+
+    leftDouble.bind(arena.carve<DoubleSection>(BiquadCascade<double>::maxSections));
+    leftFloat.bind(arena.carve<FloatSection>(BiquadCascade<float>::maxSections));
+    rightDouble.bind(arena.carve<DoubleSection>(BiquadCascade<double>::maxSections));
+    rightFloat.bind(arena.carve<FloatSection>(BiquadCascade<float>::maxSections));
+
+    reset();
+}
+
+void FilterEngine::reset()
+{
+    leftFloat.reset();
+    rightFloat.reset();
+
+   #if JUCE_USE_SIMD
+    leftParallel.reset();
+    rightParallel.reset();
+   #endif
+
+    leftDouble.reset();
+    rightDouble.reset();
+}
+
+static bool needsDoublePrecision(float frequency, double sampleRate)
+{
+    return frequency < sampleRate / 200.0;
+}
+
+void FilterEngine::setCoefficients(const ChainCoefficients& chainCoefficients)
+{
+    const auto& settings = chainCoefficients.settings;
+    auto sampleRate = chainCoefficients.sampleRate;
+
+    auto runsInDouble = [this, sampleRate](float frequency)
+        {
+            return precision == PrecisionMode::Double
+                || (precision == PrecisionMode::Mixed && needsDoublePrecision(frequency, sampleRate));
+        };
+
+    inDouble[ChainPositions::LowCut] = runsInDouble(settings.lowCutFreq);
+    inDouble[ChainPositions::Peak] = runsInDouble(settings.peakFreq);
+    inDouble[ChainPositions::HighCut] = runsInDouble(settings.highCutFreq);
+
+    const int bandSizes[] = { (int)settings.lowCutSlope + 1, 1, (int)settings.highCutSlope + 1 };
+    int numFloat = 0, numDouble = 0;
+
+    for (int band = 0; band < 3; ++band) {
+        floatStart[(size_t)band] = numFloat;
+        doubleStart[(size_t)band] = numDouble;
+        (inDouble[(size_t)band] ? numDouble : numFloat) += bandSizes[band];
+    }
+
+    anyFloat = numFloat > 0;
+    anyDouble = numDouble > 0;
+
+    leftFloat.setNumSections(numFloat);
+    rightFloat.setNumSections(numFloat);
+
+    for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut }) {
+        if (!inDouble[band]) {
+            loadFloatBand(band, chainCoefficients);
+        }
+    }
+
+   #if JUCE_USE_SIMD
+    leftParallel.setCoefficients(chainCoefficients, !inDouble[ChainPositions::LowCut], !inDouble[ChainPositions::Peak], !inDouble[ChainPositions::HighCut]);
+    rightParallel.setCoefficients(chainCoefficients, !inDouble[ChainPositions::LowCut], !inDouble[ChainPositions::Peak], !inDouble[ChainPositions::HighCut]);
+   #endif
+
+    // Double sections are designed from the settings, never widened from the float coefficients.
+    leftDouble.setNumSections(numDouble);
+    rightDouble.setNumSections(numDouble);
+
+    if (inDouble[ChainPositions::LowCut]) {
+        setCutSections(ChainPositions::LowCut, settings, sampleRate);
+    }
+
+    if (inDouble[ChainPositions::Peak]) {
+        setPeak(settings, sampleRate, settings.peakGainInDecibels);
+    }
+
+    if (inDouble[ChainPositions::HighCut]) {
+        setCutSections(ChainPositions::HighCut, settings, sampleRate);
+    }
+}
+
+void FilterEngine::setPeak(const ChainSettings& settings, double sampleRate, float gainInDecibels)
+{
+    if (inDouble[ChainPositions::Peak]) {
+        double biquad[5];
+        designPeakCoefficients(biquad, sampleRate, settings.peakFreq, settings.peakQuality, gainInDecibels);
+        setDoubleSection(ChainPositions::Peak, 0, biquad);
+    } else {
+        float biquad[5];
+        designPeakCoefficients(biquad, sampleRate, settings.peakFreq, settings.peakQuality, gainInDecibels);
+        setFloatSection(ChainPositions::Peak, 0, biquad);
+    }
+}
+
+void FilterEngine::setCutSections(ChainPositions band, const ChainSettings& settings, double sampleRate)
+{
+    jassert(band != ChainPositions::Peak);
+
+    auto highPass = band == ChainPositions::LowCut;
+    auto frequency = highPass ? settings.lowCutFreq : settings.highCutFreq;
+    auto numSections = (int)(highPass ? settings.lowCutSlope : settings.highCutSlope) + 1;
+
+    for (int i = 0; i < numSections; ++i) {
+        if (inDouble[band]) {
+            double biquad[5];
+            designCutSection(biquad, sampleRate, frequency, 2 * numSections, i, highPass);
+            setDoubleSection(band, i, biquad);
+        } else {
+            float biquad[5];
+            designCutSection(biquad, sampleRate, frequency, 2 * numSections, i, highPass);
+            setFloatSection(band, i, biquad);
+        }
+    }
+}
+
+void FilterEngine::setFloatSection(ChainPositions band, int index, const float* biquad)
+{
+    leftFloat.setSection(floatStart[band] + index, biquad);
+    rightFloat.setSection(floatStart[band] + index, biquad);
+
+   #if JUCE_USE_SIMD
+    leftParallel.setSection(floatStart[band] + index, biquad);
+    rightParallel.setSection(floatStart[band] + index, biquad);
+   #endif
+}
+
+void FilterEngine::loadFloatBand(ChainPositions band, const ChainCoefficients& chainCoefficients)
+{
+    // The block-parallel sections are designed by setCoefficients, so only the scalar ones are loaded here.
+    auto load = [this, band](int index, const juce::dsp::IIR::Coefficients<float>& coefficients)
+        {
+            float biquad[5];
+            toBiquad(coefficients, biquad);
+
+            leftFloat.setSection(floatStart[band] + index, biquad);
+            rightFloat.setSection(floatStart[band] + index, biquad);
+        };
+
+    if (band == ChainPositions::Peak) {
+        load(0, *chainCoefficients.peak);
+        return;
+    }
+
+    const auto& sections = band == ChainPositions::LowCut ? chainCoefficients.lowCut : chainCoefficients.highCut;
+
+    for (int i = 0; i < sections.size(); ++i) {
+        load(i, *sections.getObjectPointerUnchecked(i));
+    }
+}
+
+void FilterEngine::setDoubleSection(ChainPositions band, int index, const double* biquad)
+{
+    leftDouble.setSection(doubleStart[band] + index, biquad);
+    rightDouble.setSection(doubleStart[band] + index, biquad);
+}
+
+void FilterEngine::process(ProcessingBackend backend, int channel, float* data, int numSamples)
+{
+    if (anyDouble) {
+        (channel == 0 ? leftDouble : rightDouble).process(data, numSamples);
+    }
+
+    if (anyFloat) {
+        processFloat(backend, channel, data, numSamples);
+    }
+}
+
+void FilterEngine::process(ProcessingBackend backend, int channel, double* data, int numSamples)
+{
+    if (anyDouble) {
+        (channel == 0 ? leftDouble : rightDouble).process(data, numSamples);
+    }
+
+    if (!anyFloat) {
+        return;
+    }
+
+    // The float bands run on a converted copy, a chunk at a time.
+    for (int start = 0; start < numSamples; start += conversionSize) {
+        auto num = juce::jmin(conversionSize, numSamples - start);
+
+        std::copy(data + start, data + start + num, conversion.begin());
+        processFloat(backend, channel, conversion.data(), num);
+        std::copy(conversion.begin(), conversion.begin() + num, data + start);
+    }
+}
+
+void FilterEngine::processFloat(ProcessingBackend backend, int channel, float* data, int numSamples)
+{
+   #if JUCE_USE_SIMD
+    if (backend == ProcessingBackend::BlockParallel) {
+        (channel == 0 ? leftParallel : rightParallel).process(data, numSamples);
+        return;
+    }
+   #else
+    juce::ignoreUnused(backend);
+   #endif
+
+    (channel == 0 ? leftFloat : rightFloat).process(data, numSamples);
+}
+
+bool SimpleEQAudioProcessor::chainSettingsChanged()
+{
+    pendingSettings = getChainSettings(apvts);
+
+    return currentCoefficients == nullptr
+        || currentCoefficients->settings != pendingSettings
+        || currentCoefficients->sampleRate != getSampleRate();
+}
+
+void SimpleEQAudioProcessor::applyChainSettings()
+{
+    // Nothing but the processor holds the live set, so it can be redesigned in place.
+    liveCoefficients->design(pendingSettings, getSampleRate());
+    currentCoefficients = liveCoefficients;
+    liveSettings = pendingSettings;
+    morphApplied = false;
+
+    engines[(size_t)activeEngine].setCoefficients(*currentCoefficients);
+
+    dynamicPeak.setBand(pendingSettings.peakFreq, pendingSettings.peakQuality);
+
+    publishPending = true;
+}
+
+void SimpleEQAudioProcessor::publishCoefficients()
+{
+    if (!publishPending) {
+        return;
+    }
+
+    // currentCoefficients may be replaced on any tick, so a copy of it is published once per block
+    // instead. While every copy is still held (the message thread reclaims them every 50 ms) the
+    // latest set goes out on a later block.
+    for (auto& copy : publishedCopies) {
+        if (copy->getReferenceCount() == 1) {
+            copy->copyFrom(*currentCoefficients);
+            publishPending = !coefficientPublisher.publish(copy);
+            return;
+        }
+    }
 }
 
 void SimpleEQAudioProcessor::updateFilters()
 {
-    auto chainSettings = getChainSettings(apvts);
+    TraceScope trace("updateFilters");
+
+    if (chainSettingsChanged()) {
+        applyChainSettings();
+    }
+
+    publishCoefficients();
+}
+
+bool SimpleEQAudioProcessor::controlTick(int position)
+{
+    // While a program change is being applied the parameters are in flux and the precomputed
+    // coefficients are already on their way, so nothing is redesigned.
+    auto programChanging = programChangeInProgress.load(std::memory_order_relaxed) || pendingProgram.load(std::memory_order_relaxed) >= 0;
+
+    if (morphEnabled) {
+        morphAmount.setTargetValue(apvts.getRawParameterValue(MORPH_AMOUNT_PARAM_NAME)->load());
+        auto amount = morphAmount.getNextValue();
+
+        chainUpdatePending = false;
+        morphUpdatePending = !programChanging && (!morphApplied || std::abs(amount - appliedMorphAmount) > 1.0e-4f);
+    } else {
+        // Leaving morph mode hands the filters back to the knobs with a full redesign.
+        chainUpdatePending = !programChanging && (chainSettingsChanged() || morphApplied);
+        morphUpdatePending = false;
+    }
+
+    peakUpdatePending = dynamicPeak.tick(position, dynamicSettings);
 
-    updateLowCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
+    return chainUpdatePending || morphUpdatePending || peakUpdatePending;
+}
+
+void SimpleEQAudioProcessor::applyControlUpdate()
+{
+    if (chainUpdatePending) {
+        applyChainSettings();
+    }
+
+    if (morphUpdatePending) {
+        applyMorph();
+    }
+
+    // A redesign puts the peak band back at its static gain, so a live offset is laid over it again.
+    auto redesigned = chainUpdatePending || morphUpdatePending;
+
+    if (redesigned && peakOffset != 0.f) {
+        applyDynamicPeakGain();
+    }
+
+    // The ramp starts from wherever the last one got to.
+    if (peakUpdatePending) {
+        peakRampFrom = peakOffset;
+        peakRampTo = dynamicPeak.getGainOffsetInDecibels();
+        peakRampRemaining = controlQuantum;
+    }
+}
+
+void SimpleEQAudioProcessor::enterPeakRampStep()
+{
+    // Each step runs at the gain the ramp reaches at its end, so the last one lands on the target.
+    auto remainingAtStepEnd = peakRampRemaining - peakRampStep;
+    peakOffset = peakRampTo + (peakRampFrom - peakRampTo) * (float)remainingAtStepEnd / (float)controlQuantum;
+
+    applyDynamicPeakGain();
+}
+
+void SimpleEQAudioProcessor::applyDynamicPeakGain()
+{
+    engines[(size_t)activeEngine].setPeak(liveSettings, getSampleRate(), liveSettings.peakGainInDecibels + peakOffset);
+    dynamicPeakGain.store(peakOffset, std::memory_order_relaxed);
+}
+
+void SimpleEQAudioProcessor::storeMorphEndpoint(int slot)
+{
+    jassert(slot == 0 || slot == 1);
+
+    morphSlots[slot] = getChainSettings(apvts);
+    updateMorphEndpoints(getSampleRate());
+}
+
+ChainSettings SimpleEQAudioProcessor::getEffectiveChainSettings()
+{
+    if (apvts.getRawParameterValue(MORPH_PARAM_NAME)->load() > 0.5f) {
+        return interpolateChainSettings(morphSlots[0], morphSlots[1], apvts.getRawParameterValue(MORPH_AMOUNT_PARAM_NAME)->load());
+    }
+
+    return getChainSettings(apvts);
+}
+
+void SimpleEQAudioProcessor::updateMorphEndpoints(double sampleRate)
+{
+    if (sampleRate <= 0) {
+        return;
+    }
+
+    MorphEngine::EndpointPtr designs[2] = {
+        makeChainCoefficients(morphSlots[0], sampleRate),
+        makeChainCoefficients(morphSlots[1], sampleRate)
+    };
+
+    // Whatever the audio thread hasn't picked up yet is swapped out and released here, not there.
+    {
+        juce::SpinLock::ScopedLockType lock(morphLock);
+        std::swap(pendingMorphEndpoints[0], designs[0]);
+        std::swap(pendingMorphEndpoints[1], designs[1]);
+        morphEndpointsPending.store(true);
+    }
+}
+
+void SimpleEQAudioProcessor::takeMorphEndpoints()
+{
+    if (!morphEndpointsPending.load()) {
+        return;
+    }
+
+    juce::SpinLock::ScopedTryLockType lock(morphLock);
+
+    if (lock.isLocked()) {
+        // The endpoints being replaced go back into the pending slots and are released by the next store.
+        morph.swapEndpoints(pendingMorphEndpoints);
+        morphEndpointsPending.store(false);
+        morphApplied = false;
+    }
+}
+
+void SimpleEQAudioProcessor::applyMorph()
+{
+    auto amount = morphAmount.getCurrentValue();
+
+    liveSettings = morph.apply(engines[(size_t)activeEngine], amount, !morphApplied);
+    dynamicPeak.setBand(liveSettings.peakFreq, liveSettings.peakQuality);
+
+    morphApplied = true;
+    appliedMorphAmount = amount;
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::createParameterLayout()
@@ -305,6 +1278,40 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
     layout.add(std::make_unique<juce::AudioParameterChoice>(LOW_CUT_SLOPE_PARAM_NAME, LOW_CUT_SLOPE_PARAM_NAME, stringArray, 0));
     layout.add(std::make_unique<juce::AudioParameterChoice>(HIGH_CUT_SLOPE_PARAM_NAME, HIGH_CUT_SLOPE_PARAM_NAME, stringArray, 0));
 
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        PROCESSING_MODE_PARAM_NAME,
+        PROCESSING_MODE_PARAM_NAME,
+        juce::StringArray { "Stereo", "Mid-Side", "Mid only", "Side only" },
+        ProcessingMode::Stereo
+    ));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>(PEAK_DYNAMIC_PARAM_NAME, PEAK_DYNAMIC_PARAM_NAME, false));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        PEAK_THRESHOLD_PARAM_NAME,
+        PEAK_THRESHOLD_PARAM_NAME,
+        juce::NormalisableRange<float>(-60.f, 0.f, 0.5f, 1.f),
+        -24.f
+    ));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        PEAK_RANGE_PARAM_NAME,
+        PEAK_RANGE_PARAM_NAME,
+        juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+        -6.f
+    ));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>(PEAK_SIDECHAIN_PARAM_NAME, PEAK_SIDECHAIN_PARAM_NAME, false));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>(MORPH_PARAM_NAME, MORPH_PARAM_NAME, false));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        MORPH_AMOUNT_PARAM_NAME,
+        MORPH_AMOUNT_PARAM_NAME,
+        juce::NormalisableRange<float>(0.f, 1.f, 0.001f, 1.f),
+        0.f
+    ));
+
     return layout;
 }
 
@@ -2,6 +2,16 @@
 
 #include <JuceHeader.h>
 #include <array>
+#include <atomic>
+#include "BlockParallelIIR.h"
+#include "BiquadCascade.h"
+#include "DSPStateArena.h"
+#include "DynamicPeak.h"
+#include "PresetBank.h"
+#include "Morph.h"
+#include "TraceRecorder.h"
+#include "LevelMeter.h"
+#include "RenderedImageCache.h"
 
 #define LOW_CUT_FREQ_PARAM_NAME   "LowCut Freq"
 #define HIGH_CUT_FREQ_PARAM_NAME  "HighCut Freq"
@@ -10,6 +20,13 @@
 #define PEAK_QUALITY_PARAM_NAME   "Peak Quality"
 #define LOW_CUT_SLOPE_PARAM_NAME  "LowCut Slope"
 #define HIGH_CUT_SLOPE_PARAM_NAME "HighCut Slope"
+#define PROCESSING_MODE_PARAM_NAME "Processing Mode"
+#define PEAK_DYNAMIC_PARAM_NAME   "Peak Dynamic"
+#define PEAK_THRESHOLD_PARAM_NAME "Peak Threshold"
+#define PEAK_RANGE_PARAM_NAME     "Peak Range"
+#define PEAK_SIDECHAIN_PARAM_NAME "Peak Sidechain"
+#define MORPH_PARAM_NAME          "Morph"
+#define MORPH_AMOUNT_PARAM_NAME   "Morph Amount"
 
 template<typename T>
 struct Fifo
@@ -38,7 +55,7 @@ struct Fifo
         bool push(const T& t)
         {
             auto write = fifo.write(1);
-            if (write.blockSize1 > 1)
+            if (write.blockSize1 > 0)
             {
                 buffers[write.startIndex1] = t;
                 return true;
@@ -54,6 +71,8 @@ struct Fifo
                 t = buffers[read.startIndex1];
                 return true;
             }
+
+            return false;
         }
 
         int getNumAvailableForReading() const
@@ -67,69 +86,278 @@ struct Fifo
         juce::AbstractFifo fifo { Capacity };
 };
 
-enum Channel
-{
-    Right,
-    Left
-};
-
-template<typename BlockType>
-struct SingleChannelSampleInfo
+// Single-writer, multi-reader ring of recent audio. The audio thread writes each block once and every
+// reader keeps its own cursor, so any number of views can follow the same feed without stealing
+// frames from each other. A reader that falls more than a ring length behind, or is lapped while
+// copying, skips ahead and loses only its own data.
+// The ring only holds storage while views are attached: the first attach() allocates it, and a
+// while after the last detach() it is freed on the message thread once no push or read is using
+// it. Until then pushes and reads are no-ops, so a reader can also follow a feed it hasn't attached
+// and only sees what is pushed while someone else holds it.
+template<typename SampleType>
+struct BroadcastRing : private juce::Timer
 {
     public:
-        SingleChannelSampleInfo(Channel ch) : channelToUse(ch)
+        struct Reader
         {
-            prepared.set(false);
+            juce::uint64 position = 0;
+            juce::uint64 samplesDropped = 0;
+        };
+
+        BroadcastRing(int channels, int ringCapacity) : numChannels(channels), capacity(ringCapacity)
+        {
+            jassert(juce::isPowerOfTwo(capacity));
+            mask = capacity - 1;
+        }
+
+        // Message thread; attach before creating readers.
+        void attach()
+        {
+            JUCE_ASSERT_MESSAGE_THREAD
+
+            if (numAttached++ > 0) {
+                return;
+            }
+
+            stopTimer();
+
+            if (allocated == nullptr) {
+                allocated = std::make_unique<juce::AudioBuffer<SampleType>>(numChannels, capacity);
+                allocated->clear();
+                allocatedBytes.store((size_t)(numChannels * capacity) * sizeof(SampleType));
+            }
+
+            storage.store(allocated.get());
+        }
+
+        void detach()
+        {
+            JUCE_ASSERT_MESSAGE_THREAD
+            jassert(numAttached > 0);
+
+            if (--numAttached == 0) {
+                storage.store(nullptr);
+                startTimer(releaseDelayMs);
+            }
         }
 
-        void update(const BlockType& buffer)
+        template<typename OtherType>
+        void push(const juce::AudioBuffer<OtherType>& buffer, int numSamples)
         {
-            jassert(prepared.get());
-            jassert(buffer.getNumChannels() > channelToUse);
-            auto* channelPtr = buffer.getReadPointer(channelToUse);
+            if (storage.load(std::memory_order_relaxed) == nullptr) {
+                return;
+            }
+
+            ScopedAccess access(*this);
 
-            for (int i = 0; i < buffer.getNumSamples(); i++) {
-                pushNextSampleIntoFifo(channelPtr[i]);
+            if (access.buffer == nullptr) {
+                return;
             }
+
+            const auto skip = juce::jmax(0, numSamples - capacity);
+            const auto toWrite = numSamples - skip;
+            const auto start = writePosition.load(std::memory_order_relaxed) + (juce::uint64)skip;
+
+            // Announce the range about to be overwritten before touching it, so readers can tell
+            // whether the samples they just copied were still intact.
+            reservedPosition.store(start + (juce::uint64)toWrite, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            const auto index = (int)(start & (juce::uint64)mask);
+            const auto first = juce::jmin(toWrite, capacity - index);
+
+            for (int channel = 0; channel < numChannels; ++channel) {
+                auto sourceChannel = juce::jmin(channel, buffer.getNumChannels() - 1);
+                auto* source = buffer.getReadPointer(sourceChannel, skip);
+
+                copyIntoStorage(*access.buffer, channel, index, source, first);
+                copyIntoStorage(*access.buffer, channel, 0, source + first, toWrite - first);
+            }
+
+            writePosition.store(start + (juce::uint64)toWrite, std::memory_order_release);
         }
 
-        void prepare(int bufferSize)
+        Reader createReader() const
         {
-            prepared.set(false);
-            size.set(bufferSize);
+            return { writePosition.load(std::memory_order_acquire), 0 };
+        }
 
-            bufferToFill.setSize(1, bufferSize, false, true, true);
-            audioBufferFifo.prepare(1, bufferSize);
-            fifoIndex = 0;
-            prepared.set(true);
+        int getNumAvailable(const Reader& reader) const
+        {
+            auto available = writePosition.load(std::memory_order_acquire) - reader.position;
+            return (int)juce::jmin(available, (juce::uint64)capacity);
         }
 
-        int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
-        bool isPrepared() const { return prepared.get(); }
-        int getSize() const { return size.get(); }
-        bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
+        // Moves the reader on so that at most numToKeep samples are left to read. Skipped audio
+        // isn't counted as dropped.
+        void skipToLatest(Reader& reader, int numToKeep) const
+        {
+            auto written = writePosition.load(std::memory_order_acquire);
+
+            if (written - reader.position > (juce::uint64)numToKeep) {
+                reader.position = written - (juce::uint64)numToKeep;
+            }
+        }
+
+        bool read(Reader& reader, juce::AudioBuffer<SampleType>& destination, int numSamples)
+        {
+            jassert(numSamples <= capacity && numSamples <= destination.getNumSamples());
+
+            ScopedAccess access(*this);
+
+            if (access.buffer == nullptr) {
+                return false;
+            }
+
+            const auto written = writePosition.load(std::memory_order_acquire);
+
+            if (written - reader.position > (juce::uint64)capacity) {
+                resync(reader, written);
+            }
+
+            if (written - reader.position < (juce::uint64)numSamples) {
+                return false;
+            }
+
+            const auto index = (int)(reader.position & (juce::uint64)mask);
+            const auto first = juce::jmin(numSamples, capacity - index);
+            const auto channelsToCopy = juce::jmin(destination.getNumChannels(), numChannels);
+
+            for (int channel = 0; channel < channelsToCopy; ++channel) {
+                destination.copyFrom(channel, 0, *access.buffer, channel, index, first);
+                destination.copyFrom(channel, first, *access.buffer, channel, 0, numSamples - first);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (reservedPosition.load(std::memory_order_relaxed) - reader.position > (juce::uint64)capacity) {
+                resync(reader, writePosition.load(std::memory_order_acquire));
+                return false;
+            }
+
+            reader.position += (juce::uint64)numSamples;
+            return true;
+        }
+
+        int getNumChannels() const { return numChannels; }
+
+        // Bytes currently allocated for the ring, any thread.
+        size_t getAllocatedBytes() const { return allocatedBytes.load(std::memory_order_relaxed); }
 
     private:
-        Channel channelToUse;
-        int fifoIndex = 0;
-        Fifo<BlockType> audioBufferFifo;
-        BlockType bufferToFill;
-        juce::Atomic<bool> prepared = false;
-        juce::Atomic<int> size = 0;
-
-        void pushNextSampleIntoFifo(float sample)
+        static constexpr int releaseDelayMs = 1000;
+
+        // Counts the pushes and reads in flight, so the storage is only freed once it is
+        // unpublished and nobody can still be holding it. Both sides use sequentially consistent
+        // operations: an access that starts after release() saw zero also sees the null pointer.
+        struct ScopedAccess
         {
-            if (fifoIndex == bufferToFill.getNumSamples())
+            ScopedAccess(BroadcastRing& r) : ring(r)
+            {
+                ring.numAccessing.fetch_add(1);
+                buffer = ring.storage.load();
+            }
+
+            ~ScopedAccess()
             {
-                auto ok = audioBufferFifo.push(bufferToFill);
+                ring.numAccessing.fetch_sub(1);
+            }
+
+            BroadcastRing& ring;
+            juce::AudioBuffer<SampleType>* buffer;
+        };
+
+        const int numChannels, capacity;
+        int mask = 0;
+        std::atomic<juce::uint64> writePosition { 0 }, reservedPosition { 0 };
+
+        std::unique_ptr<juce::AudioBuffer<SampleType>> allocated;
+        std::atomic<juce::AudioBuffer<SampleType>*> storage { nullptr };
+        std::atomic<int> numAccessing { 0 };
+        std::atomic<size_t> allocatedBytes { 0 };
+        int numAttached = 0;
+
+        void timerCallback() override
+        {
+            // Still busy; try again next tick.
+            if (numAccessing.load() != 0) {
+                return;
+            }
+
+            stopTimer();
+            allocated.reset();
+            allocatedBytes.store(0);
+        }
+
+        static void resync(Reader& reader, juce::uint64 position)
+        {
+            reader.samplesDropped += position - reader.position;
+            reader.position = position;
+        }
+
+        template<typename OtherType>
+        static void copyIntoStorage(juce::AudioBuffer<SampleType>& destination, int channel, int index,
+                                    const OtherType* source, int numSamples)
+        {
+            if constexpr (std::is_same_v<OtherType, SampleType>) {
+                destination.copyFrom(channel, index, source, numSamples);
+            } else {
+                std::copy(source, source + numSamples, destination.getWritePointer(channel, index));
+            }
+        }
+};
+
+// Runs control-rate work on a fixed grid of `quantum` samples, however the host slices its blocks,
+// and hands the audio in between to a render callback in chunks of at most `maxSubBlockSize`.
+// needsUpdate receives the tick's offset into the block. Audio is only split at a tick when that
+// tick actually has something to apply, so large blocks
+// still render in one pass and 1-sample blocks pay a counter decrement between ticks.
+struct SubBlockScheduler
+{
+    public:
+        void prepare(int controlQuantum, int maxSubBlock)
+        {
+            quantum = juce::jmax(1, controlQuantum);
+            maxSubBlockSize = juce::jmax(quantum, maxSubBlock);
+            reset();
+        }
+
+        void reset() { samplesUntilTick = 0; }
 
-                juce::ignoreUnused(ok);
+        int getMaxSubBlockSize() const { return maxSubBlockSize; }
+        int getSamplesUntilTick() const { return samplesUntilTick; }
 
-                fifoIndex = 0;
+        template<typename NeedsUpdate, typename ApplyUpdate, typename Render>
+        void process(int numSamples, NeedsUpdate&& needsUpdate, ApplyUpdate&& applyUpdate, Render&& render)
+        {
+            int runStart = 0;
+            int tick = samplesUntilTick;
+
+            for (; tick < numSamples; tick += quantum) {
+                if (needsUpdate(tick)) {
+                    renderRun(runStart, tick, render);
+                    runStart = tick;
+                    applyUpdate();
+                }
             }
 
-            bufferToFill.setSample(0, fifoIndex, sample);
-            ++fifoIndex;
+            renderRun(runStart, numSamples, render);
+            samplesUntilTick = tick - numSamples;
+        }
+
+    private:
+        int quantum = 32;
+        int maxSubBlockSize = 512;
+        int samplesUntilTick = 0;
+
+        template<typename Render>
+        void renderRun(int start, int end, Render& render)
+        {
+            while (start < end) {
+                auto numSamples = juce::jmin(end - start, maxSubBlockSize);
+                render(start, numSamples);
+                start += numSamples;
+            }
         }
 };
 
@@ -141,17 +369,36 @@ enum Slope
     Slope_48
 };
 
+enum ProcessingMode
+{
+    Stereo,
+    MidSide,
+    MidOnly,
+    SideOnly
+};
+
 struct ChainSettings
 {
     float peakFreq { 0 }, peakGainInDecibels { 0 }, peakQuality { 1.f };
     float lowCutFreq { 0 }, highCutFreq { 0 };
 
     Slope lowCutSlope { Slope::Slope_12 }, highCutSlope { Slope::Slope_12 };
+
+    bool operator==(const ChainSettings& other) const
+    {
+        return peakFreq == other.peakFreq
+            && peakGainInDecibels == other.peakGainInDecibels
+            && peakQuality == other.peakQuality
+            && lowCutFreq == other.lowCutFreq
+            && highCutFreq == other.highCutFreq
+            && lowCutSlope == other.lowCutSlope
+            && highCutSlope == other.highCutSlope;
+    }
+
+    bool operator!=(const ChainSettings& other) const { return !(*this == other); }
 };
 
 using Filter = juce::dsp::IIR::Filter<float>;
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
 
 enum ChainPositions
 {
@@ -161,53 +408,177 @@ enum ChainPositions
 };
 
 using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacement);
 
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, const CoefficientType& coefficients)
+// Copies a JUCE design into a normalised biquad (b0, b1, b2, a1, a2); first-order sections are padded.
+void toBiquad(const juce::dsp::IIR::Coefficients<float>& coefficients, float* biquad);
+
+// Same design as IIR::Coefficients::makePeakFilter, written over an existing normalised biquad
+// (b0, b1, b2, a1, a2) so the band can move on the audio thread without allocating.
+template<typename FloatType>
+void designPeakCoefficients(FloatType* coefficients, double sampleRate, float frequency, float quality, float gainInDecibels)
 {
-    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-    chain.template setBypassed<Index>(false);
+    auto A = std::sqrt(juce::Decibels::decibelsToGain((double)gainInDecibels));
+    auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    auto alpha = std::sin(omega) / (2.0 * quality);
+    auto c2 = -2.0 * std::cos(omega);
+    auto a0 = 1.0 + alpha / A;
+
+    coefficients[0] = (FloatType)((1.0 + alpha * A) / a0);
+    coefficients[1] = (FloatType)(c2 / a0);
+    coefficients[2] = (FloatType)((1.0 - alpha * A) / a0);
+    coefficients[3] = (FloatType)(c2 / a0);
+    coefficients[4] = (FloatType)((1.0 - alpha / A) / a0);
 }
 
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& chain, const CoefficientType& coefficients, const Slope& slope)
+// One section of an even-order Butterworth cascade, matching FilterDesign's
+// designIIR{High,Low}passHighOrderButterworthMethod, written over an existing normalised biquad.
+template<typename FloatType>
+void designCutSection(FloatType* coefficients, double sampleRate, float frequency, int order, int section, bool highPass)
 {
-    chain.template setBypassed<0>(true);
-    chain.template setBypassed<1>(true);
-    chain.template setBypassed<2>(true);
-    chain.template setBypassed<3>(true);
-
-    switch (slope)
-    {
-    case Slope_48: update<3>(chain, coefficients);
-    case Slope_36: update<2>(chain, coefficients);
-    case Slope_24: update<1>(chain, coefficients);
-    case Slope_12: update<0>(chain, coefficients);
-    }
+    jassert(order % 2 == 0 && section < order / 2);
+
+    auto invQ = 2.0 * std::cos((2.0 * section + 1.0) * juce::MathConstants<double>::pi / (order * 2.0));
+    auto k = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    auto n = highPass ? k : 1.0 / k;
+    auto nSquared = n * n;
+    auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    coefficients[0] = (FloatType)c1;
+    coefficients[1] = (FloatType)(highPass ? -2.0 * c1 : 2.0 * c1);
+    coefficients[2] = (FloatType)c1;
+    coefficients[3] = (FloatType)(2.0 * c1 * (highPass ? nSquared - 1.0 : 1.0 - nSquared));
+    coefficients[4] = (FloatType)(c1 * (1.0 - invQ * n + nSquared));
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
 
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+// Which implementation runs the filter cascade on the audio thread.
+// MonoChain is the reference scalar cascade; BlockParallel evaluates several consecutive samples per SIMD step.
+enum class ProcessingBackend
 {
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(
-        chainSettings.lowCutFreq,
-        sampleRate,
-        2 * (chainSettings.lowCutSlope + 1)
-    );
-}
+    MonoChain,
+    BlockParallel
+};
 
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+// Which arithmetic the filter sections run in. Mixed runs only the bands whose poles sit close to
+// z = 1 (cutoff or centre below sampleRate / 200) in double, and the rest on the float backend.
+enum class PrecisionMode
 {
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(
-        chainSettings.highCutFreq,
-        sampleRate,
-        2 * (chainSettings.highCutSlope + 1)
-    );
-}
+    Float,
+    Double,
+    Mixed
+};
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+// Finished coefficient set for one ChainSettings at one sample rate.
+// Never modified after it has been published, so any number of readers can share it; the
+// processor only refills sets that nothing else holds.
+struct ChainCoefficients : juce::ReferenceCountedObject
+{
+    public:
+        using Ptr = juce::ReferenceCountedObjectPtr<ChainCoefficients>;
+        using CutCoefficients = juce::ReferenceCountedArray<juce::dsp::IIR::Coefficients<float>>;
+
+        // Allocates the sections of the steepest slopes up front, so design() and copyFrom() never allocate.
+        ChainCoefficients();
+
+        // The same float designs as IIR::Coefficients::makePeakFilter and FilterDesign's Butterworth
+        // cascades, written over this set's sections.
+        void design(const ChainSettings& chainSettings, double newSampleRate);
+        void copyFrom(const ChainCoefficients& other);
+
+        double getMagnitudeForFrequency(double frequency) const;
+
+        ChainSettings settings;
+        double sampleRate = 0;
+
+        Coefficients peak;
+        CutCoefficients lowCut, highCut;
+
+    private:
+        static constexpr int maxCutSections = Slope_48 + 1;
+
+        CutCoefficients lowCutSections, highCutSections;
+
+        static void useSections(CutCoefficients& cut, const CutCoefficients& sections, int numSections);
+};
+
+ChainCoefficients::Ptr makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate);
+
+// Single-writer publication of ChainCoefficients snapshots.
+// The writer (audio thread) swaps the latest pointer and hands the previous one to a retire queue.
+// Retired snapshots are released on the message thread, which is also the only thread allowed to call
+// getLatest(), so a reader can never observe a snapshot that is being reclaimed.
+struct CoefficientPublisher : private juce::Timer
+{
+    public:
+        CoefficientPublisher();
+        ~CoefficientPublisher() override;
+
+        bool publish(const ChainCoefficients::Ptr& snapshot);
+        ChainCoefficients::Ptr getLatest() const;
+
+    private:
+        static constexpr int RetiredCapacity = 32;
+        static constexpr int ReclaimIntervalMs = 50;
+
+        std::atomic<ChainCoefficients*> latest { nullptr };
+        std::array<ChainCoefficients*, RetiredCapacity> retired {};
+        juce::AbstractFifo retiredFifo { RetiredCapacity };
+
+        void timerCallback() override;
+        void reclaim();
+};
+
+// One stereo set of filters for every backend. The processor keeps two, so a program change can
+// bring in the new coefficients on fresh filters while the old ones fade out.
+// The scalar cascades' sections live in the processor's DSPStateArena, per channel in the order
+// they run: the double bands, then the float ones.
+struct FilterEngine
+{
+    public:
+        BiquadCascade<float> leftFloat, rightFloat;
+
+       #if JUCE_USE_SIMD
+        BlockParallelCascade leftParallel, rightParallel;
+       #endif
+
+        BiquadCascade<double> leftDouble, rightDouble;
+
+        // Bytes one engine carves from the arena.
+        static constexpr size_t getArenaSize()
+        {
+            return 2 * (DSPStateArena::getSliceSize(BiquadCascade<double>::maxSections * sizeof(BiquadCascade<double>::Section))
+                      + DSPStateArena::getSliceSize(BiquadCascade<float>::maxSections * sizeof(BiquadCascade<float>::Section)));
+        }
+
+        void prepare(DSPStateArena& arena);
+        void reset();
+        void setPrecision(PrecisionMode newPrecision) { precision = newPrecision; }
+        void setCoefficients(const ChainCoefficients& chainCoefficients);
+        void setPeak(const ChainSettings& settings, double sampleRate, float gainInDecibels);
+        void setCutSections(ChainPositions band, const ChainSettings& settings, double sampleRate);
+
+        void process(ProcessingBackend backend, int channel, float* data, int numSamples);
+        void process(ProcessingBackend backend, int channel, double* data, int numSamples);
+
+    private:
+        static constexpr int conversionSize = 256;
+
+        PrecisionMode precision = PrecisionMode::Float;
+
+        // Per band: whether it runs in double, and where its first section sits in the float
+        // and double cascades.
+        std::array<bool, 3> inDouble {};
+        std::array<int, 3> floatStart {}, doubleStart {};
+        bool anyFloat = true, anyDouble = false;
+
+        std::array<float, conversionSize> conversion;
+
+        void processFloat(ProcessingBackend backend, int channel, float* data, int numSamples);
+        void setFloatSection(ChainPositions band, int index, const float* biquad);
+        void setDoubleSection(ChainPositions band, int index, const double* biquad);
+        void loadFloatBand(ChainPositions band, const ChainCoefficients& chainCoefficients);
+};
 
 class SimpleEQAudioProcessor  : public juce::AudioProcessor
 {
@@ -225,6 +596,8 @@ class SimpleEQAudioProcessor  : public juce::AudioProcessor
        #endif
 
         void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+        void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+        bool supportsDoublePrecisionProcessing() const override { return true; }
 
         //==============================================================================
         juce::AudioProcessorEditor* createEditor() override;
@@ -253,18 +626,149 @@ class SimpleEQAudioProcessor  : public juce::AudioProcessor
 
         juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameterLayout()};
 
-        using BlockType = juce::AudioBuffer<float>;
-        SingleChannelSampleInfo<BlockType> leftChannelFifo { Channel::Left };
-        SingleChannelSampleInfo<BlockType> rightChannelFifo { Channel::Right };
-    private:
-        MonoChain leftChain, rightChain;
+        ChainCoefficients::Ptr getCoefficientsForDisplay();
+
+        void setProcessingBackend(ProcessingBackend newBackend);
+        ProcessingBackend getProcessingBackend() const { return requestedBackend.load(); }
+
+        void setPrecisionMode(PrecisionMode newPrecision);
+        PrecisionMode getPrecisionMode() const { return requestedPrecision.load(); }
+
+        float getDynamicPeakGain() const { return dynamicPeakGain.load(std::memory_order_relaxed); }
+
+        // Smoothed share of each block's real-time budget spent in processBlock.
+        float getAudioLoad() const { return (float)loadMeasurer.getLoadAsProportion(); }
+
+        void storeMorphEndpoint(int slot);
+        ChainSettings getEffectiveChainSettings();
+
+        BroadcastRing<float> analyzerFeed { 2, 1 << 15 };
+
+        // The dry input, for analyzers that derive the output from it.
+        BroadcastRing<float> inputFeed { 2, 1 << 15 };
+
+        // Bytes held by this instance, any thread. The analyzer feeds only count while a view is attached.
+        struct MemoryUsage
+        {
+            size_t dspState = 0;
+            size_t analyzerFeeds = 0;
+        };
 
-        void updatePeakFilter(const ChainSettings& chainSettings);
-        void updateLowCutFilters(const ChainSettings& chainSettings);
-        void updateHighCutFilters(const ChainSettings& chainSettings);
+        MemoryUsage getMemoryUsage() const;
 
+        const LevelMeter& getInputMeter() const { return inputMeter; }
+        const LevelMeter& getOutputMeter() const { return outputMeter; }
+    private:
+        DSPStateArena stateArena;
+        std::array<FilterEngine, 2> engines;
+        int activeEngine = 0;
+
+        static constexpr double crossfadeMs = 10.0;
+        int crossfadeLength = 0;
+        int crossfadeRemaining = 0;
+        juce::AudioBuffer<float> crossfadeBuffer;
+        juce::AudioBuffer<double> crossfadeBufferDouble;
+
+        juce::SharedResourcePointer<PresetBank> presetBank;
+        // Not used here; holding it keeps the editors' artwork across closing and reopening them.
+        juce::SharedResourcePointer<RenderedImageCache> imageCache;
+        juce::ReferenceCountedArray<ChainCoefficients> presetCoefficients;
+        int currentProgram = 0;
+        std::atomic<int> pendingProgram { -1 };
+        std::atomic<bool> programChangeInProgress { false };
+
+        std::atomic<ProcessingBackend> requestedBackend { ProcessingBackend::MonoChain };
+        ProcessingBackend activeBackend = ProcessingBackend::MonoChain;
+
+        std::atomic<PrecisionMode> requestedPrecision { PrecisionMode::Float };
+        PrecisionMode activePrecision = PrecisionMode::Float;
+
+        ProcessingMode processingMode = ProcessingMode::Stereo;
+
+        static constexpr int controlQuantum = 32;
+        SubBlockScheduler scheduler;
+
+        CoefficientPublisher coefficientPublisher;
+        ChainCoefficients::Ptr currentCoefficients;
+        // Copies of currentCoefficients go out through these, so no set the audio thread replaces has
+        // been published; a copy is free again once the publisher has reclaimed it.
+        std::array<ChainCoefficients::Ptr, 4> publishedCopies;
+        // Redesigned in place whenever the settings move; currentCoefficients points here or at a preset.
+        ChainCoefficients::Ptr liveCoefficients;
+        ChainSettings pendingSettings;
+        bool publishPending = false;
+
+        ChainSettings liveSettings;
+
+        MorphEngine morph;
+        ChainSettings morphSlots[2];
+        juce::SpinLock morphLock;
+        MorphEngine::EndpointPtr pendingMorphEndpoints[2];
+        std::atomic<bool> morphEndpointsPending { false };
+        juce::SmoothedValue<float> morphAmount;
+        bool morphEnabled = false;
+        bool morphApplied = false;
+        bool morphUpdatePending = false;
+        float appliedMorphAmount = 0;
+
+        DynamicPeakDetector dynamicPeak;
+        DynamicPeakSettings dynamicSettings;
+        bool chainUpdatePending = false;
+        bool peakUpdatePending = false;
+        std::atomic<float> dynamicPeakGain { 0 };
+
+        // Each new offset from the detector is ramped in over the following quantum, the peak band
+        // being redesigned every peakRampStep samples, so a fast attack doesn't step the gain a
+        // whole tick's move at once.
+        static constexpr int peakRampStep = 8;
+        static_assert(controlQuantum % peakRampStep == 0, "A ramp must be whole steps");
+        float peakOffset = 0;
+        float peakRampFrom = 0, peakRampTo = 0;
+        int peakRampRemaining = 0;
+
+        ChainCoefficients::Ptr idleCoefficients;
+        std::atomic<juce::uint32> lastProcessTime { 0 };
+
+        juce::AudioProcessLoadMeasurer loadMeasurer;
+        std::atomic<size_t> dspStateBytes { 0 };
+
+        LevelMeter inputMeter, outputMeter;
+
+        bool chainSettingsChanged();
+        void applyChainSettings();
+        void publishCoefficients();
         void updateFilters();
 
+        bool controlTick(int position);
+        void applyControlUpdate();
+        void applyDynamicPeakGain();
+        void enterPeakRampStep();
+
+        void updateMorphEndpoints(double sampleRate);
+        void takeMorphEndpoints();
+        void applyMorph();
+
+        void resetBackend();
+        void applyPrecision();
+
+        template<typename SampleType>
+        void processAudio(juce::AudioBuffer<SampleType>& buffer);
+
+        template<typename SampleType>
+        void renderRun(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples);
+
+        template<typename SampleType>
+        void processSubBlock(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples);
+
+        template<typename SampleType>
+        void renderEngine(FilterEngine& engine, juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples);
+
+        float getPresetValue(const Preset& preset, const juce::String& parameterID);
+        ChainSettings getPresetChainSettings(const Preset& preset);
+        void applyPresetValues(const Preset& preset);
+        void preparePresetCoefficients(double sampleRate);
+        void startProgramChange(int program);
+
         //==============================================================================
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessor)
 };
@@ -0,0 +1,157 @@
+#include "PresetBank.h"
+#include "PluginProcessor.h"
+
+namespace
+{
+    constexpr int presetMagic = 0x50514553; // "SEQP"
+    constexpr int presetVersion = 1;
+    constexpr int maxPresetValues = 256;
+
+    const char* const presetFileExtension = ".seqpreset";
+}
+
+const PresetValue* Preset::find(const juce::String& parameterID) const
+{
+    for (auto& value : values) {
+        if (value.parameterID == parameterID) {
+            return &value;
+        }
+    }
+
+    return nullptr;
+}
+
+void writePreset(juce::OutputStream& output, const Preset& preset, int program)
+{
+    output.writeInt(presetMagic);
+    output.writeShort((short)presetVersion);
+    output.writeShort((short)program);
+    output.writeString(preset.name);
+
+    output.writeShort((short)preset.values.size());
+
+    for (auto& value : preset.values) {
+        output.writeString(value.parameterID);
+        output.writeFloat(value.value);
+    }
+}
+
+bool readPreset(juce::InputStream& input, Preset& preset, int& program)
+{
+    if (input.getNumBytesRemaining() < 8 || input.readInt() != presetMagic) {
+        return false;
+    }
+
+    // Newer versions may change the layout; older ones are read by the same code until they do.
+    if (input.readShort() > presetVersion) {
+        return false;
+    }
+
+    program = input.readShort();
+    preset.name = input.readString();
+
+    auto count = (int)(unsigned short)input.readShort();
+
+    if (count > maxPresetValues) {
+        return false;
+    }
+
+    preset.values.clear();
+    preset.values.reserve((size_t)count);
+
+    for (int i = 0; i < count; ++i) {
+        auto parameterID = input.readString();
+        auto value = input.readFloat();
+
+        if (input.isExhausted() && i + 1 < count) {
+            return false;
+        }
+
+        preset.values.push_back({ parameterID, value });
+    }
+
+    return true;
+}
+
+PresetBank::PresetBank()
+{
+    addFactoryPresets();
+    loadUserPresets();
+}
+
+juce::File PresetBank::getUserPresetDirectory()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("SimpleEQ")
+        .getChildFile("Presets");
+}
+
+void PresetBank::addFactoryPresets()
+{
+    presets.push_back({ "Init", {} });
+
+    presets.push_back({ "Rumble Filter", {
+        { LOW_CUT_FREQ_PARAM_NAME, 80.f },
+        { LOW_CUT_SLOPE_PARAM_NAME, (float)Slope::Slope_24 },
+    } });
+
+    presets.push_back({ "Vocal Presence", {
+        { LOW_CUT_FREQ_PARAM_NAME, 100.f },
+        { PEAK_FREQ_PARAM_NAME, 3000.f },
+        { PEAK_GAIN_PARAM_NAME, 3.f },
+        { PEAK_QUALITY_PARAM_NAME, 0.8f },
+        { HIGH_CUT_FREQ_PARAM_NAME, 18000.f },
+    } });
+
+    presets.push_back({ "Telephone", {
+        { LOW_CUT_FREQ_PARAM_NAME, 400.f },
+        { LOW_CUT_SLOPE_PARAM_NAME, (float)Slope::Slope_48 },
+        { PEAK_FREQ_PARAM_NAME, 1500.f },
+        { PEAK_GAIN_PARAM_NAME, 4.f },
+        { HIGH_CUT_FREQ_PARAM_NAME, 3400.f },
+        { HIGH_CUT_SLOPE_PARAM_NAME, (float)Slope::Slope_48 },
+    } });
+
+    presets.push_back({ "De-Esser", {
+        { PEAK_FREQ_PARAM_NAME, 6500.f },
+        { PEAK_QUALITY_PARAM_NAME, 2.f },
+        { PEAK_DYNAMIC_PARAM_NAME, 1.f },
+        { PEAK_THRESHOLD_PARAM_NAME, -30.f },
+        { PEAK_RANGE_PARAM_NAME, -9.f },
+    } });
+
+    presets.push_back({ "Resonance Tamer", {
+        { PEAK_FREQ_PARAM_NAME, 250.f },
+        { PEAK_QUALITY_PARAM_NAME, 3.f },
+        { PEAK_DYNAMIC_PARAM_NAME, 1.f },
+        { PEAK_THRESHOLD_PARAM_NAME, -24.f },
+        { PEAK_RANGE_PARAM_NAME, -6.f },
+    } });
+
+    presets.push_back({ "Side Air", {
+        { PROCESSING_MODE_PARAM_NAME, (float)ProcessingMode::SideOnly },
+        { PEAK_FREQ_PARAM_NAME, 10000.f },
+        { PEAK_GAIN_PARAM_NAME, 4.f },
+        { PEAK_QUALITY_PARAM_NAME, 0.7f },
+    } });
+}
+
+void PresetBank::loadUserPresets()
+{
+    auto files = getUserPresetDirectory().findChildFiles(juce::File::findFiles, false, juce::String("*") + presetFileExtension);
+    files.sort();
+
+    for (auto& file : files) {
+        juce::FileInputStream input(file);
+        Preset preset;
+        int program = 0;
+
+        if (input.openedOk() && readPreset(input, preset, program)) {
+            if (preset.name.isEmpty()) {
+                preset.name = file.getFileNameWithoutExtension();
+            }
+
+            presets.push_back(std::move(preset));
+        }
+    }
+}
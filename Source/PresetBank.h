@@ -0,0 +1,46 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+struct PresetValue
+{
+    juce::String parameterID;
+    float value;
+};
+
+// A full set of parameter values. Parameters a preset doesn't list take their default.
+struct Preset
+{
+    juce::String name;
+    std::vector<PresetValue> values;
+
+    const PresetValue* find(const juce::String& parameterID) const;
+};
+
+// Compact binary state, shared by the plug-in state and preset files (little endian):
+//     uint32 magic "SEQP", uint16 version, int16 program, UTF-8 name,
+//     uint16 count, count x { UTF-8 parameter ID, float value }
+// Values are stored in the parameters' own units, so presets survive range changes, and readers
+// skip IDs they don't know.
+void writePreset(juce::OutputStream& output, const Preset& preset, int program);
+bool readPreset(juce::InputStream& input, Preset& preset, int& program);
+
+// Factory presets followed by the user presets found on disk, loaded once per process and only
+// read afterwards, so every instance can share it.
+struct PresetBank
+{
+    public:
+        PresetBank();
+
+        int size() const { return (int)presets.size(); }
+        const Preset& operator[](int index) const { return presets[(size_t)index]; }
+
+        static juce::File getUserPresetDirectory();
+
+    private:
+        std::vector<Preset> presets;
+
+        void addFactoryPresets();
+        void loadUserPresets();
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+
+// Process-wide store of pre-rendered editor artwork, shared through juce::SharedResourcePointer.
+// Every processor holds it too, so it lives as long as the plug-in rather than the editors, and a
+// reopened editor finds its artwork already rendered. Images are keyed by everything they depend
+// on (size, pixel scale, content) and rendered once. Of the entries no editor holds any more, only
+// the maxUnheldImages most recently used are kept; the rest are dropped whenever an entry is
+// added, which is the only time the cache grows. Message thread only.
+struct RenderedImageCache
+{
+    public:
+        template<typename Renderer>
+        juce::Image get(const juce::String& key, Renderer&& render)
+        {
+            JUCE_ASSERT_MESSAGE_THREAD
+
+            auto found = images.find(key);
+
+            if (found != images.end()) {
+                found->second.lastUsed = ++useCount;
+                return found->second.image;
+            }
+
+            auto image = render();
+            images.emplace(key, Entry { image, ++useCount });
+
+            trim();
+
+            return image;
+        }
+
+    private:
+        static constexpr size_t maxUnheldImages = 4;
+
+        struct Entry
+        {
+            juce::Image image;
+            juce::uint64 lastUsed = 0;
+        };
+
+        std::map<juce::String, Entry> images;
+        juce::uint64 useCount = 0;
+
+        static bool isHeld(const Entry& entry) { return entry.image.getReferenceCount() > 1; }
+
+        void trim()
+        {
+            auto numUnheld = (size_t)std::count_if(images.begin(), images.end(), [](const auto& item) { return !isHeld(item.second); });
+
+            while (numUnheld > maxUnheldImages) {
+                auto oldest = images.end();
+
+                for (auto it = images.begin(); it != images.end(); ++it) {
+                    if (!isHeld(it->second) && (oldest == images.end() || it->second.lastUsed < oldest->second.lastUsed)) {
+                        oldest = it;
+                    }
+                }
+
+                images.erase(oldest);
+                --numUnheld;
+            }
+        }
+};
@@ -0,0 +1,122 @@
+#include "SpectrogramComponent.h"
+#include "PluginEditor.h"
+
+SpectrogramComponent::SpectrogramComponent(float minDb, float maxDb) :
+minDecibels(minDb),
+maxDecibels(maxDb)
+{
+    juce::ColourGradient gradient(juce::Colours::black, 0, 0, juce::Colours::white, 1, 0, false);
+    gradient.addColour(0.4, SLIDER_FILL_COLOR);
+    gradient.addColour(0.75, SLIDER_BORDER_COLOR);
+
+    gradient.createLookupTable(colourTable, colourTableSize);
+
+    setOpaque(true);
+}
+
+void SpectrogramComponent::clear()
+{
+    if (image.isValid()) {
+        image.clear(image.getBounds(), juce::Colours::black);
+    }
+
+    writeColumn = 0;
+    repaint();
+}
+
+void SpectrogramComponent::resized()
+{
+    // A new size or pixel scale starts the history over; paint allocates the new ring.
+    image = {};
+    rowStarts.clear();
+}
+
+void SpectrogramComponent::updateRowMap(int numValues, Layout layout, double sampleRate)
+{
+    mappedValues = numValues;
+    mappedLayout = layout;
+    mappedSampleRate = sampleRate;
+
+    const auto height = image.getHeight();
+    rowStarts.resize((size_t)height + 1);
+
+    // Row edges, from the top of the image (20kHz) down.
+    for (int edge = 0; edge <= height; ++edge) {
+        auto normY = 1.0 - double(edge) / double(height);
+        double index;
+
+        if (layout == Layout::LogPoints) {
+            index = normY * (numValues - 1);
+        } else {
+            auto binWidth = sampleRate / double(numValues * 2);
+            index = juce::mapToLog10(normY, 20.0, 20000.0) / binWidth;
+        }
+
+        rowStarts[(size_t)edge] = juce::jlimit(0, numValues - 1, (int)std::round(index));
+    }
+}
+
+void SpectrogramComponent::pushFrame(const float* decibels, int numValues, Layout layout, double sampleRate)
+{
+    if (!image.isValid() || numValues < 2 || (layout == Layout::LinearBins && sampleRate <= 0)) {
+        return;
+    }
+
+    if (rowStarts.empty() || numValues != mappedValues || layout != mappedLayout || sampleRate != mappedSampleRate) {
+        updateRowMap(numValues, layout, sampleRate);
+    }
+
+    const auto height = image.getHeight();
+    const auto scale = float(colourTableSize - 1) / (maxDecibels - minDecibels);
+
+    juce::Image::BitmapData column(image, writeColumn, 0, 1, height, juce::Image::BitmapData::writeOnly);
+
+    for (int y = 0; y < height; ++y) {
+        // Rows are spaced top down and frequency falls downwards, so a row's range runs backwards.
+        auto first = rowStarts[(size_t)y + 1];
+        auto last = juce::jmax(first, rowStarts[(size_t)y] - 1);
+
+        auto level = decibels[first];
+
+        for (int i = first + 1; i <= last; ++i) {
+            level = juce::jmax(level, decibels[i]);
+        }
+
+        auto index = juce::jlimit(0, colourTableSize - 1, (int)((level - minDecibels) * scale));
+        *reinterpret_cast<juce::PixelARGB*>(column.getLinePointer(y)) = colourTable[index];
+    }
+
+    writeColumn = (writeColumn + 1) % image.getWidth();
+
+    repaint();
+}
+
+void SpectrogramComponent::paint(juce::Graphics& g)
+{
+    using namespace juce;
+
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (image.isNull() || scale != imageScale) {
+        imageScale = scale;
+
+        image = Image(Image::ARGB, jmax(1, roundToInt(getWidth() * scale)), jmax(1, roundToInt(getHeight() * scale)), false);
+        image.clear(image.getBounds(), Colours::black);
+        writeColumn = 0;
+        rowStarts.clear();
+    }
+
+    // The oldest column is the next one to be written, so the ring unrolls from there.
+    const auto width = image.getWidth();
+    const auto height = image.getHeight();
+    const auto older = width - writeColumn;
+
+    Graphics::ScopedSaveState state(g);
+    g.addTransform(AffineTransform::scale(1.f / scale));
+
+    g.drawImage(image, 0, 0, older, height, writeColumn, 0, older, height);
+
+    if (writeColumn > 0) {
+        g.drawImage(image, older, 0, writeColumn, height, 0, 0, writeColumn, height);
+    }
+}
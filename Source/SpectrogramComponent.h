@@ -0,0 +1,44 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Scrolling spectrogram, newest frame on the right, frequency rising upwards on a log scale.
+// The image is a ring of columns at the physical pixel scale: each frame overwrites the oldest
+// column through a precomputed row-to-bin map and dB-to-colour table, and paint draws the ring
+// as two blits split at the write position. So a frame costs one column, whatever the width.
+// Message thread only.
+struct SpectrogramComponent : juce::Component
+{
+    public:
+        enum class Layout
+        {
+            LinearBins,     // FFT bins from 0Hz to Nyquist
+            LogPoints       // display points spaced evenly across 20Hz..20kHz
+        };
+
+        SpectrogramComponent(float minDecibels, float maxDecibels);
+
+        void pushFrame(const float* decibels, int numValues, Layout layout, double sampleRate);
+        void clear();
+
+        void paint(juce::Graphics& g) override;
+        void resized() override;
+
+    private:
+        static constexpr int colourTableSize = 256;
+
+        float minDecibels, maxDecibels;
+        juce::PixelARGB colourTable[colourTableSize];
+
+        juce::Image image;
+        float imageScale = 0;
+        int writeColumn = 0;
+
+        // Rows run top to bottom; each takes the loudest value in [rowStarts[y], rowStarts[y + 1]).
+        std::vector<int> rowStarts;
+        int mappedValues = 0;
+        Layout mappedLayout = Layout::LinearBins;
+        double mappedSampleRate = 0;
+
+        void updateRowMap(int numValues, Layout layout, double sampleRate);
+};
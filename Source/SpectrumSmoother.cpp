@@ -0,0 +1,93 @@
+#include "SpectrumSmoother.h"
+
+void SpectrumSmoother::prepare(const std::vector<float>& binFrequencies, float framesPerSecond, float negativeInfinity)
+{
+    frequencies = binFrequencies;
+    floor = negativeInfinity;
+
+    tilt.assign(frequencies.size(), 0.f);
+    average.assign(frequencies.size(), floor);
+    peak.assign(frequencies.size(), floor);
+    primed = false;
+
+    frameRate = 0;
+    setFrameRate(framesPerSecond);
+}
+
+void SpectrumSmoother::setFrameRate(float framesPerSecond)
+{
+    if (framesPerSecond > 0 && framesPerSecond != frameRate) {
+        frameRate = framesPerSecond;
+        updateCoefficients();
+    }
+}
+
+void SpectrumSmoother::setSettings(const Settings& newSettings)
+{
+    const juce::SpinLock::ScopedLockType lock(settingsLock);
+    pendingSettings = newSettings;
+    settingsChanged.store(true, std::memory_order_release);
+}
+
+SpectrumSmoother::Settings SpectrumSmoother::getSettings() const
+{
+    const juce::SpinLock::ScopedLockType lock(settingsLock);
+    return settingsChanged.load(std::memory_order_acquire) ? pendingSettings : settings;
+}
+
+void SpectrumSmoother::updateCoefficients()
+{
+    averagingCoefficient = settings.averagingTimeMs > 0 && frameRate > 0
+        ? std::exp(-1000.f / (settings.averagingTimeMs * frameRate))
+        : 0.f;
+
+    peakDecayPerFrame = frameRate > 0 ? settings.peakDecayDbPerSecond / frameRate : 0.f;
+
+    // Tilt pivots around 1kHz, so the midrange level stays where it was.
+    for (size_t i = 0; i < frequencies.size(); ++i) {
+        auto octaves = frequencies[i] > 0 ? std::log2(frequencies[i] / 1000.f) : 0.f;
+        tilt[i] = settings.tiltDbPerOctave * octaves;
+    }
+}
+
+void SpectrumSmoother::process(float* frame, float* peaks, int numValues)
+{
+    using FVO = juce::FloatVectorOperations;
+
+    jassert(numValues == (int)average.size());
+
+    if (settingsChanged.load(std::memory_order_acquire)) {
+        const juce::SpinLock::ScopedTryLockType lock(settingsLock);
+
+        if (lock.isLocked()) {
+            settings = pendingSettings;
+            settingsChanged.store(false, std::memory_order_relaxed);
+            updateCoefficients();
+        }
+    }
+
+    if (settings.tiltDbPerOctave != 0.f) {
+        FVO::add(frame, tilt.data(), numValues);
+    }
+
+    if (!primed || averagingCoefficient <= 0.f) {
+        FVO::copy(average.data(), frame, numValues);
+        primed = true;
+    }
+    else {
+        FVO::multiply(average.data(), averagingCoefficient, numValues);
+        FVO::addWithMultiply(average.data(), frame, 1.f - averagingCoefficient, numValues);
+        FVO::copy(frame, average.data(), numValues);
+    }
+
+    if (settings.peakHold) {
+        FVO::add(peak.data(), -peakDecayPerFrame, numValues);
+        FVO::max(peak.data(), peak.data(), frame, numValues);
+    }
+    else {
+        FVO::copy(peak.data(), frame, numValues);
+    }
+
+    FVO::max(frame, frame, floor, numValues);
+    FVO::max(peaks, peak.data(), floor, numValues);
+}
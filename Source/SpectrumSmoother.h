@@ -0,0 +1,41 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Post-FFT display conditioning: slope tilt, exponential averaging and peak hold with decay.
+// Works on one frame of decibel values laid out as any number of spectra back to back; the
+// per-bin tilt table and per-frame coefficients are precomputed so every mode is a handful of
+// FloatVectorOperations calls over the whole frame.
+struct SpectrumSmoother
+{
+    public:
+        struct Settings
+        {
+            float averagingTimeMs { 300.f };
+            bool peakHold { false };
+            float peakDecayDbPerSecond { 12.f };
+            float tiltDbPerOctave { 0.f };
+        };
+
+        void prepare(const std::vector<float>& binFrequencies, float framesPerSecond, float negativeInfinity);
+        void setFrameRate(float framesPerSecond);
+        void setSettings(const Settings& newSettings);
+        Settings getSettings() const;
+
+        // Smooths `frame` in place and writes the peak-hold trace to `peaks` (same length).
+        void process(float* frame, float* peaks, int numValues);
+
+    private:
+        Settings settings, pendingSettings;
+        mutable juce::SpinLock settingsLock;
+        std::atomic<bool> settingsChanged { false };
+
+        std::vector<float> frequencies, tilt, average, peak;
+        float frameRate = 0;
+        float floor = -48.f;
+        float averagingCoefficient = 0;
+        float peakDecayPerFrame = 0;
+        bool primed = false;
+
+        void updateCoefficients();
+};
@@ -0,0 +1,196 @@
+#include "TraceRecorder.h"
+
+namespace
+{
+    // Events this close to being overwritten may be torn mid-snapshot and are left out.
+    constexpr juce::uint64 snapshotMargin = 64;
+}
+
+std::atomic<bool> TraceRecorder::enabled { false };
+thread_local TraceRecorder::ThreadSlot TraceRecorder::threadSlot;
+
+TraceRecorder::ThreadSlot::~ThreadSlot()
+{
+    if (index >= 0) {
+        getInstance().ringInUse[(size_t)index].store(false, std::memory_order_release);
+    }
+}
+
+TraceRecorder& TraceRecorder::getInstance()
+{
+    static TraceRecorder instance;
+    return instance;
+}
+
+void TraceRecorder::start()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (isEnabled()) {
+        return;
+    }
+
+    if (rings[0] == nullptr) {
+        for (auto& ring : rings) {
+            ring = std::make_unique<Ring>();
+        }
+    }
+
+    // A new trace leaves out whatever the rings held from the last one.
+    for (auto& ring : rings) {
+        ring->firstEvent = ring->numWritten.load(std::memory_order_acquire);
+    }
+
+    originTicks.store(juce::Time::getHighResolutionTicks());
+    enabled.store(true, std::memory_order_release);
+}
+
+void TraceRecorder::stop()
+{
+    enabled.store(false, std::memory_order_release);
+}
+
+TraceRecorder::Ring* TraceRecorder::getThreadRing() noexcept
+{
+    // Threads that find every ring taken aren't recorded until one is handed back.
+    if (threadSlot.index == -1) {
+        threadSlot.index = claimRing();
+    }
+
+    return threadSlot.index >= 0 ? rings[(size_t)threadSlot.index].get() : nullptr;
+}
+
+int TraceRecorder::claimRing() noexcept
+{
+    for (int index = 0; index < maxThreads; ++index) {
+        auto& inUse = ringInUse[(size_t)index];
+        bool expected = false;
+
+        if (inUse.load(std::memory_order_relaxed) || !inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            continue;
+        }
+
+        auto used = numClaimed.load();
+        while (used <= index && !numClaimed.compare_exchange_weak(used, index + 1)) {}
+
+        // The track takes the new owner's name; its earlier events stay under it.
+        auto& ring = *rings[(size_t)index];
+        ring.threadName.store(juce::MessageManager::existsAndIsCurrentThread() ? "Message" : nullptr, std::memory_order_relaxed);
+
+        return index;
+    }
+
+    return -1;
+}
+
+void TraceRecorder::record(const char* name, bool isEnd) noexcept
+{
+    auto* ring = getThreadRing();
+
+    if (ring == nullptr) {
+        return;
+    }
+
+    auto index = ring->numWritten.load(std::memory_order_relaxed);
+    auto& event = ring->events[(size_t)(index & (ringSize - 1))];
+
+    event.name.store(name, std::memory_order_relaxed);
+    event.stamp.store(juce::Time::getHighResolutionTicks() * 2 + (isEnd ? 1 : 0), std::memory_order_relaxed);
+
+    ring->numWritten.store(index + 1, std::memory_order_release);
+}
+
+void TraceRecorder::nameCurrentThread(const char* name) noexcept
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    if (auto* ring = getInstance().getThreadRing()) {
+        if (ring->threadName.load(std::memory_order_relaxed) == nullptr) {
+            ring->threadName.store(name, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool TraceRecorder::writeTrace(const juce::File& destination)
+{
+    struct Snapshot
+    {
+        const char* name;
+        juce::int64 stamp;
+    };
+
+    destination.deleteFile();
+    juce::FileOutputStream out(destination);
+
+    if (!out.openedOk()) {
+        return false;
+    }
+
+    const auto origin = originTicks.load();
+    auto toMicroseconds = [origin](juce::int64 ticks)
+        {
+            return juce::Time::highResolutionTicksToSeconds(ticks - origin) * 1.0e6;
+        };
+
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+
+    auto numRings = juce::jmin(numClaimed.load(), maxThreads);
+    std::vector<Snapshot> events;
+
+    for (int tid = 0; tid < numRings; ++tid) {
+        auto& ring = *rings[(size_t)tid];
+
+        // Copy first, then drop anything the owning thread may have overwritten meanwhile.
+        auto written = ring.numWritten.load(std::memory_order_acquire);
+        auto oldest = juce::jmax(ring.firstEvent, written > (juce::uint64)ringSize ? written - ringSize : 0);
+
+        events.clear();
+
+        for (auto i = oldest; i < written; ++i) {
+            const auto& event = ring.events[(size_t)(i & (ringSize - 1))];
+            events.push_back({ event.name.load(std::memory_order_relaxed), event.stamp.load(std::memory_order_relaxed) });
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto nowWritten = ring.numWritten.load(std::memory_order_relaxed);
+        auto firstValid = nowWritten + snapshotMargin > (juce::uint64)ringSize ? nowWritten + snapshotMargin - ringSize : 0;
+        auto skip = (size_t)juce::jmin((juce::uint64)events.size(), firstValid > oldest ? firstValid - oldest : 0);
+
+        auto* threadName = ring.threadName.load(std::memory_order_relaxed);
+
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"name\":\"" << (threadName != nullptr ? juce::String(threadName) : "Thread " + juce::String(tid)) << "\"}}";
+        first = false;
+
+        // The ring may start in the middle of a scope; its unmatched end is dropped.
+        int depth = 0;
+
+        for (auto i = skip; i < events.size(); ++i) {
+            auto isEnd = (events[i].stamp & 1) != 0;
+
+            if (isEnd && depth == 0) {
+                continue;
+            }
+
+            depth += isEnd ? -1 : 1;
+
+            out << ",\n{\"name\":\"" << events[i].name << "\",\"ph\":\"" << (isEnd ? "E" : "B")
+                << "\",\"pid\":1,\"tid\":" << tid
+                << ",\"ts\":" << juce::String(toMicroseconds(events[i].stamp >> 1), 3) << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    out.flush();
+
+    return out.getStatus().wasOk();
+}
+
+void TraceRecorder::writeTraceAsync(const juce::File& destination)
+{
+    juce::Thread::launch([this, destination] { writeTrace(destination); });
+}
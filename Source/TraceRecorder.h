@@ -0,0 +1,99 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+// Process-wide event recorder for correlating the audio callback with analysis and UI work.
+// Each thread that records claims its own ring of begin/end events on first use, so recording
+// is a couple of relaxed stores with no locks or allocation. A thread hands its ring back when it
+// exits, and the next new thread takes it over along with its track in the trace, so threads that
+// come and go (a host restarting its device, a harness trial per thread) are still recorded once
+// all rings have been used. The rings keep the most recent events only; writeTrace snapshots
+// them and writes Chrome trace JSON (chrome://tracing or Perfetto). While tracing is stopped a
+// TraceScope costs one atomic load.
+struct TraceRecorder
+{
+    public:
+        static TraceRecorder& getInstance();
+
+        // Acquire, so a thread that sees tracing on also sees the rings start() allocated.
+        static bool isEnabled() noexcept { return enabled.load(std::memory_order_acquire); }
+
+        // Message thread. The rings are allocated the first time tracing starts.
+        void start();
+        void stop();
+
+        bool writeTrace(const juce::File& destination);
+        void writeTraceAsync(const juce::File& destination);
+
+        static void begin(const char* name) noexcept { getInstance().record(name, false); }
+        static void end(const char* name) noexcept { getInstance().record(name, true); }
+
+        // Labels the calling thread in the trace; names must be string literals.
+        static void nameCurrentThread(const char* name) noexcept;
+
+    private:
+        static constexpr int maxThreads = 16;
+        static constexpr int ringSize = 1 << 15;
+
+        struct Event
+        {
+            std::atomic<const char*> name { nullptr };
+            std::atomic<juce::int64> stamp { 0 };   // high-resolution ticks * 2, plus 1 for an end
+        };
+
+        struct Ring
+        {
+            std::atomic<juce::uint64> numWritten { 0 };
+            std::atomic<const char*> threadName { nullptr };
+            juce::uint64 firstEvent = 0;
+            std::array<Event, ringSize> events;
+        };
+
+        // The calling thread's ring, released when the thread exits.
+        struct ThreadSlot
+        {
+            int index = -1;
+            ~ThreadSlot();
+        };
+
+        static std::atomic<bool> enabled;
+        static thread_local ThreadSlot threadSlot;
+
+        std::array<std::unique_ptr<Ring>, maxThreads> rings;
+        std::array<std::atomic<bool>, maxThreads> ringInUse {};
+        std::atomic<int> numClaimed { 0 };      // rings ever used
+        std::atomic<juce::int64> originTicks { 0 };
+
+        TraceRecorder() = default;
+
+        Ring* getThreadRing() noexcept;
+        int claimRing() noexcept;
+        void record(const char* name, bool isEnd) noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE(TraceRecorder)
+};
+
+struct TraceScope
+{
+    public:
+        explicit TraceScope(const char* n) noexcept : name(n), active(TraceRecorder::isEnabled())
+        {
+            if (active) {
+                TraceRecorder::begin(name);
+            }
+        }
+
+        ~TraceScope()
+        {
+            if (active) {
+                TraceRecorder::end(name);
+            }
+        }
+
+    private:
+        const char* name;
+        bool active;
+
+        JUCE_DECLARE_NON_COPYABLE(TraceScope)
+};
@@ -0,0 +1,654 @@
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/OfflineRenderer.h"
+#include "Regression.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+// Headless stress harness for SimpleEQ.
+//
+// Runs N processors in one process against a simulated audio device: one callback per block
+// period, every instance processed in turn on the callback thread, with random parameter jumps
+// applied before each block. A callback that ends after its period has run out is a deadline
+// miss. Without --instances, the largest instance count that runs without a miss is searched for.
+//
+//   --instances N       run N instances once instead of searching
+//   --max-instances N   upper bound for the search (1024)
+//   --block N           block size (128)
+//   --rate N            sample rate (48000)
+//   --seconds N         simulated time per run (5)
+//   --automation P      chance per instance per block of a parameter jump (0.25)
+//   --backend B         chain | parallel
+//   --precision P       float | double | mixed
+//   --double-host       process AudioBuffer<double>
+//   --morph             sweep the morph amount between two endpoints
+//   --editors           open every instance's editor so its analysis runs alongside
+//   --freewheel         run callbacks back to back instead of on the clock
+//   --bench             time one instance across backends, precisions and block sizes
+//   --trace FILE        record the last moments of the run as Chrome trace JSON
+//
+//   --render FILE       render an audio file offline instead, split across cores
+//   --output FILE       where the render goes, as 24-bit WAV (FILE_render.wav)
+//   --threads N         render threads (one per core)
+//   --program N         factory program to render with (the default settings)
+//   --verify            also render serially and compare
+//
+//   --regression        compare every backend and precision against a JUCE IIR::Filter reference
+//                       and the analytic magnitude response; exits non-zero on any failure
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double toMilliseconds(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    struct Options
+    {
+        int numInstances = 0;
+        int maxInstances = 1024;
+        int blockSize = 128;
+        double sampleRate = 48000;
+        double seconds = 5;
+        double automationRate = 0.25;
+        ProcessingBackend backend = ProcessingBackend::MonoChain;
+        PrecisionMode precision = PrecisionMode::Float;
+        bool doubleHost = false;
+        bool morph = false;
+        bool editors = false;
+        bool freewheel = false;
+        bool bench = false;
+        juce::File traceFile;
+        juce::File renderFile, outputFile;
+        int numThreads = 0;
+        int program = -1;
+        bool verify = false;
+        bool regression = false;
+    };
+
+    Options parseOptions(const juce::ArgumentList& args)
+    {
+        Options options;
+
+        auto value = [&](const char* name) { return args.getValueForOption(name); };
+
+        if (args.containsOption("--instances")) {
+            options.numInstances = juce::jmax(1, value("--instances").getIntValue());
+        }
+
+        if (args.containsOption("--max-instances")) {
+            options.maxInstances = juce::jmax(1, value("--max-instances").getIntValue());
+        }
+
+        if (args.containsOption("--block")) {
+            options.blockSize = juce::jmax(1, value("--block").getIntValue());
+        }
+
+        if (args.containsOption("--rate")) {
+            options.sampleRate = juce::jmax(8000.0, value("--rate").getDoubleValue());
+        }
+
+        if (args.containsOption("--seconds")) {
+            options.seconds = juce::jmax(0.1, value("--seconds").getDoubleValue());
+        }
+
+        if (args.containsOption("--automation")) {
+            options.automationRate = juce::jlimit(0.0, 1.0, value("--automation").getDoubleValue());
+        }
+
+        if (value("--backend") == "parallel") {
+            options.backend = ProcessingBackend::BlockParallel;
+        }
+
+        if (value("--precision") == "double") {
+            options.precision = PrecisionMode::Double;
+        } else if (value("--precision") == "mixed") {
+            options.precision = PrecisionMode::Mixed;
+        }
+
+        options.doubleHost = args.containsOption("--double-host");
+        options.morph = args.containsOption("--morph");
+        options.editors = args.containsOption("--editors");
+        options.freewheel = args.containsOption("--freewheel");
+        options.bench = args.containsOption("--bench");
+
+        if (args.containsOption("--trace")) {
+            options.traceFile = juce::File::getCurrentWorkingDirectory().getChildFile(value("--trace"));
+        }
+
+        if (args.containsOption("--render")) {
+            options.renderFile = juce::File::getCurrentWorkingDirectory().getChildFile(value("--render"));
+            options.outputFile = args.containsOption("--output")
+                ? juce::File::getCurrentWorkingDirectory().getChildFile(value("--output"))
+                : options.renderFile.getSiblingFile(options.renderFile.getFileNameWithoutExtension() + "_render.wav");
+        }
+
+        if (args.containsOption("--threads")) {
+            options.numThreads = juce::jmax(1, value("--threads").getIntValue());
+        }
+
+        if (args.containsOption("--program")) {
+            options.program = value("--program").getIntValue();
+        }
+
+        options.verify = args.containsOption("--verify");
+
+        options.regression = args.containsOption("--regression");
+
+        return options;
+    }
+
+    const char* getBackendName(ProcessingBackend backend)
+    {
+        return backend == ProcessingBackend::MonoChain ? "chain" : "parallel";
+    }
+
+    const char* getPrecisionName(PrecisionMode precision)
+    {
+        switch (precision) {
+            case PrecisionMode::Double: return "double";
+            case PrecisionMode::Mixed:  return "mixed";
+            case PrecisionMode::Float:  break;
+        }
+
+        return "float";
+    }
+
+    // One second of pre-rendered noise, so a callback only pays for copying its input.
+    struct TestSignal
+    {
+        public:
+            explicit TestSignal(double sampleRate) :
+            floatSamples(2, juce::roundToInt(sampleRate)),
+            doubleSamples(2, juce::roundToInt(sampleRate))
+            {
+                juce::Random random(1);
+
+                for (int channel = 0; channel < 2; ++channel) {
+                    for (int i = 0; i < floatSamples.getNumSamples(); ++i) {
+                        auto sample = random.nextFloat() - 0.5f;
+                        floatSamples.setSample(channel, i, sample);
+                        doubleSamples.setSample(channel, i, sample);
+                    }
+                }
+            }
+
+            void read(juce::AudioBuffer<float>& destination, int& position) const { copyWrapped(floatSamples, destination, position); }
+            void read(juce::AudioBuffer<double>& destination, int& position) const { copyWrapped(doubleSamples, destination, position); }
+
+        private:
+            juce::AudioBuffer<float> floatSamples;
+            juce::AudioBuffer<double> doubleSamples;
+
+            template<typename SampleType>
+            static void copyWrapped(const juce::AudioBuffer<SampleType>& source, juce::AudioBuffer<SampleType>& destination, int& position)
+            {
+                auto length = source.getNumSamples();
+
+                for (int done = 0; done < destination.getNumSamples();) {
+                    auto num = juce::jmin(destination.getNumSamples() - done, length - position);
+
+                    for (int channel = 0; channel < destination.getNumChannels(); ++channel) {
+                        destination.copyFrom(channel, done, source, channel % source.getNumChannels(), position, num);
+                    }
+
+                    done += num;
+                    position = (position + num) % length;
+                }
+            }
+    };
+
+    struct Instance
+    {
+        public:
+            Instance(const Options& o, int seed) : options(o), random(seed)
+            {
+                processor.setProcessingPrecision(options.doubleHost ? juce::AudioProcessor::doublePrecision
+                                                                    : juce::AudioProcessor::singlePrecision);
+                processor.setRateAndBufferSizeDetails(options.sampleRate, options.blockSize);
+                processor.setProcessingBackend(options.backend);
+                processor.setPrecisionMode(options.precision);
+                processor.prepareToPlay(options.sampleRate, options.blockSize);
+
+                auto numChannels = juce::jmax(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+                floatBuffer.setSize(numChannels, options.blockSize);
+                doubleBuffer.setSize(numChannels, options.blockSize);
+
+                // Every band starts out active, so the filters do their full work from the first block.
+                setParameter(LOW_CUT_FREQ_PARAM_NAME, 30.f);
+                setParameter(LOW_CUT_SLOPE_PARAM_NAME, 3.f);
+                setParameter(PEAK_FREQ_PARAM_NAME, 1000.f);
+                setParameter(PEAK_GAIN_PARAM_NAME, 6.f);
+                setParameter(HIGH_CUT_FREQ_PARAM_NAME, 16000.f);
+                setParameter(HIGH_CUT_SLOPE_PARAM_NAME, 3.f);
+
+                if (options.morph) {
+                    processor.storeMorphEndpoint(0);
+
+                    setParameter(LOW_CUT_FREQ_PARAM_NAME, 200.f);
+                    setParameter(PEAK_FREQ_PARAM_NAME, 3000.f);
+                    setParameter(PEAK_GAIN_PARAM_NAME, -6.f);
+                    setParameter(PEAK_QUALITY_PARAM_NAME, 2.f);
+                    setParameter(HIGH_CUT_FREQ_PARAM_NAME, 8000.f);
+                    processor.storeMorphEndpoint(1);
+
+                    setParameter(MORPH_PARAM_NAME, 1.f);
+                }
+
+                // The morph is driven by the sweep only, so random jumps leave it alone.
+                for (auto* parameter : processor.getParameters()) {
+                    if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter)) {
+                        if (ranged->getParameterID() != MORPH_PARAM_NAME && ranged->getParameterID() != MORPH_AMOUNT_PARAM_NAME) {
+                            automatable.add(ranged);
+                        }
+                    }
+                }
+
+                signalPosition = random.nextInt(juce::roundToInt(options.sampleRate));
+                morphPhase = random.nextDouble();
+            }
+
+            ~Instance()
+            {
+                editor.reset();
+                processor.releaseResources();
+            }
+
+            // Message thread only.
+            void openEditor()
+            {
+                editor.reset(processor.createEditorIfNeeded());
+
+                // Renders the first frame, as showing the window would; the editor's analysis
+                // starts after that.
+                editor->createComponentSnapshot(editor->getLocalBounds());
+            }
+
+            void processCallback(const TestSignal& signal)
+            {
+                if (random.nextDouble() < options.automationRate) {
+                    auto* parameter = automatable[random.nextInt(automatable.size())];
+                    parameter->setValueNotifyingHost(random.nextFloat());
+                }
+
+                if (options.morph) {
+                    // Triangle sweep from A to B and back once a second.
+                    morphPhase = std::fmod(morphPhase + options.blockSize / options.sampleRate, 1.0);
+                    setParameter(MORPH_AMOUNT_PARAM_NAME, (float)(1.0 - std::abs(2.0 * morphPhase - 1.0)));
+                }
+
+                if (options.doubleHost) {
+                    signal.read(doubleBuffer, signalPosition);
+                    processor.processBlock(doubleBuffer, midi);
+                } else {
+                    signal.read(floatBuffer, signalPosition);
+                    processor.processBlock(floatBuffer, midi);
+                }
+            }
+
+            SimpleEQAudioProcessor::MemoryUsage getMemoryUsage() const { return processor.getMemoryUsage(); }
+
+        private:
+            const Options& options;
+
+            SimpleEQAudioProcessor processor;
+            std::unique_ptr<juce::AudioProcessorEditor> editor;
+
+            juce::AudioBuffer<float> floatBuffer;
+            juce::AudioBuffer<double> doubleBuffer;
+            juce::MidiBuffer midi;
+            int signalPosition = 0;
+
+            juce::Random random;
+            juce::Array<juce::RangedAudioParameter*> automatable;
+            double morphPhase = 0;
+
+            void setParameter(const juce::String& parameterID, float value)
+            {
+                if (auto* parameter = processor.apvts.getParameter(parameterID)) {
+                    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+                }
+            }
+    };
+
+    struct TrialResult
+    {
+        int numInstances = 0;
+        juce::int64 numCallbacks = 0, numMisses = 0;
+        double budgetMs = 0, meanMs = 0, worstMs = 0;
+        size_t dspBytes = 0, analyzerBytes = 0;
+
+        bool passed() const { return numMisses == 0; }
+    };
+
+    // Plays the audio device: one callback per block period, measured against its deadline.
+    struct CallbackThread : juce::Thread
+    {
+        public:
+            CallbackThread(const Options& o, const juce::OwnedArray<Instance>& i, const TestSignal& s) :
+            juce::Thread("Stress callback"), options(o), instances(i), signal(s)
+            {
+            }
+
+            void run() override
+            {
+                const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.blockSize / options.sampleRate));
+                const auto numCallbacks = (juce::int64)std::ceil(options.seconds * options.sampleRate / options.blockSize);
+
+                Clock::duration total {}, worst {};
+                auto next = Clock::now();
+
+                for (juce::int64 i = 0; i < numCallbacks && !threadShouldExit(); ++i) {
+                    if (!options.freewheel) {
+                        waitUntil(next);
+                    }
+
+                    auto start = Clock::now();
+
+                    for (auto* instance : instances) {
+                        instance->processCallback(signal);
+                    }
+
+                    auto end = Clock::now();
+                    auto elapsed = end - start;
+
+                    total += elapsed;
+                    worst = juce::jmax(worst, elapsed);
+                    ++result.numCallbacks;
+
+                    // A late callback is a dropout; like a device, the clock then carries on from now
+                    // instead of charging every following callback for it.
+                    auto deadline = (options.freewheel ? start : next) + period;
+
+                    if (end > deadline) {
+                        ++result.numMisses;
+                        next = end;
+                    } else {
+                        next += period;
+                    }
+                }
+
+                result.budgetMs = toMilliseconds(period);
+                result.meanMs = result.numCallbacks > 0 ? toMilliseconds(total) / (double)result.numCallbacks : 0.0;
+                result.worstMs = toMilliseconds(worst);
+            }
+
+            TrialResult result;
+
+        private:
+            const Options& options;
+            const juce::OwnedArray<Instance>& instances;
+            const TestSignal& signal;
+
+            // Sleeps most of the way and spins the rest, so wake-up jitter doesn't eat the budget.
+            static void waitUntil(Clock::time_point target)
+            {
+                auto spinFrom = target - std::chrono::milliseconds(1);
+
+                if (Clock::now() < spinFrom) {
+                    std::this_thread::sleep_until(spinFrom);
+                }
+
+                while (Clock::now() < target) {
+                    std::this_thread::yield();
+                }
+            }
+    };
+
+    TrialResult runTrial(const Options& options, int numInstances, const TestSignal& signal)
+    {
+        juce::OwnedArray<Instance> instances;
+
+        for (int i = 0; i < numInstances; ++i) {
+            instances.add(new Instance(options, i + 1));
+
+            if (options.editors) {
+                instances.getLast()->openEditor();
+            }
+        }
+
+        CallbackThread thread(options, instances, signal);
+        thread.startThread(juce::Thread::Priority::highest);
+
+        // The message loop keeps running so the editors pick up their analysis results as in a host.
+        while (thread.isThreadRunning()) {
+            juce::MessageManager::getInstance()->runDispatchLoopUntil(20);
+        }
+
+        auto result = thread.result;
+        result.numInstances = numInstances;
+
+        for (auto* instance : instances) {
+            auto usage = instance->getMemoryUsage();
+            result.dspBytes += usage.dspState;
+            result.analyzerBytes += usage.analyzerFeeds;
+        }
+
+        return result;
+    }
+
+    bool report(const TrialResult& result)
+    {
+        std::printf("%5d instances  %8lld callbacks  %6lld misses  mean %7.3f ms  worst %7.3f ms  budget %6.3f ms  (%5.1f%% worst)"
+                    "  dsp %6.1f KiB  feeds %6.1f KiB\n",
+                    result.numInstances, (long long)result.numCallbacks, (long long)result.numMisses,
+                    result.meanMs, result.worstMs, result.budgetMs, 100.0 * result.worstMs / result.budgetMs,
+                    result.dspBytes / 1024.0, result.analyzerBytes / 1024.0);
+        std::fflush(stdout);
+
+        return result.passed();
+    }
+
+    // Doubles the instance count until a run misses a deadline, then bisects between the last
+    // passing and the first failing count.
+    int findMaxInstances(const Options& options, const TestSignal& signal)
+    {
+        int passing = 0, failing = 0;
+
+        for (int n = 1; n <= options.maxInstances; n *= 2) {
+            if (!report(runTrial(options, n, signal))) {
+                failing = n;
+                break;
+            }
+
+            passing = n;
+        }
+
+        if (failing == 0) {
+            return passing;
+        }
+
+        while (failing - passing > 1) {
+            auto n = (passing + failing) / 2;
+
+            if (report(runTrial(options, n, signal))) {
+                passing = n;
+            } else {
+                failing = n;
+            }
+        }
+
+        return passing;
+    }
+
+    // Cost of one instance in ns per sample, freewheeling, for every backend, precision, host
+    // sample type and morph state across block sizes down to a single sample.
+    void runBenchmarks(Options options, const TestSignal& signal)
+    {
+        static constexpr int blockSizes[] = { 1, 16, 32, 64, 256, 1024 };
+
+        options.freewheel = true;
+        options.editors = false;
+        options.automationRate = 0;
+
+        std::printf("backend   precision  host    morph  ");
+        for (auto blockSize : blockSizes) {
+            std::printf("%8d", blockSize);
+        }
+        std::printf("   (ns/sample by block size)\n");
+
+        for (auto backend : { ProcessingBackend::MonoChain, ProcessingBackend::BlockParallel }) {
+            for (auto precision : { PrecisionMode::Float, PrecisionMode::Double, PrecisionMode::Mixed }) {
+                for (auto doubleHost : { false, true }) {
+                    for (auto morph : { false, true }) {
+                        options.backend = backend;
+                        options.precision = precision;
+                        options.doubleHost = doubleHost;
+                        options.morph = morph;
+
+                        std::printf("%-9s %-10s %-7s %-6s ", getBackendName(backend), getPrecisionName(precision),
+                                    doubleHost ? "double" : "float", morph ? "on" : "off");
+
+                        for (auto blockSize : blockSizes) {
+                            options.blockSize = blockSize;
+                            auto result = runTrial(options, 1, signal);
+                            std::printf("%8.2f", result.meanMs * 1.0e6 / blockSize);
+                            std::fflush(stdout);
+                        }
+
+                        std::printf("\n");
+                    }
+                }
+            }
+        }
+    }
+
+    bool runRender(const Options& options)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(options.renderFile));
+
+        if (reader == nullptr) {
+            std::printf("can't read %s\n", options.renderFile.getFullPathName().toRawUTF8());
+            return false;
+        }
+
+        auto sampleRate = reader->sampleRate;
+        juce::AudioBuffer<float> input(juce::jlimit(1, 2, (int)reader->numChannels), (int)reader->lengthInSamples);
+        reader->read(&input, 0, input.getNumSamples(), 0, true, input.getNumChannels() > 1);
+
+        SimpleEQAudioProcessor processor;
+        processor.setProcessingBackend(options.backend);
+        processor.setPrecisionMode(options.precision);
+
+        if (options.program >= 0 && options.program < processor.getNumPrograms()) {
+            processor.setCurrentProgram(options.program);
+        }
+
+        OfflineRenderer::Options renderOptions;
+        renderOptions.blockSize = options.blockSize;
+        renderOptions.numThreads = options.numThreads;
+
+        auto coefficients = makeChainCoefficients(processor.getEffectiveChainSettings(), sampleRate);
+
+        std::printf("%s: %d channels, %d samples @ %.0f Hz, pre-roll %d samples\n",
+                    options.renderFile.getFileName().toRawUTF8(), input.getNumChannels(), input.getNumSamples(), sampleRate,
+                    OfflineRenderer::getPreRollSamples(*coefficients, renderOptions.toleranceInDecibels));
+
+        juce::AudioBuffer<float> output(input.getNumChannels(), input.getNumSamples());
+
+        auto start = Clock::now();
+        OfflineRenderer::render(processor, sampleRate, input, output, renderOptions);
+        auto parallelTime = toMilliseconds(Clock::now() - start);
+
+        std::printf("rendered in %.1f ms (%.1fx real time)\n", parallelTime,
+                    input.getNumSamples() / sampleRate * 1000.0 / juce::jmax(1.0e-3, parallelTime));
+
+        if (options.verify) {
+            juce::AudioBuffer<float> reference(input.getNumChannels(), input.getNumSamples());
+
+            start = Clock::now();
+            OfflineRenderer::renderSerial(processor, sampleRate, input, reference, options.blockSize);
+            auto serialTime = toMilliseconds(Clock::now() - start);
+
+            float maxError = 0;
+
+            for (int channel = 0; channel < output.getNumChannels(); ++channel) {
+                auto* a = output.getReadPointer(channel);
+                auto* b = reference.getReadPointer(channel);
+
+                for (int i = 0; i < output.getNumSamples(); ++i) {
+                    maxError = juce::jmax(maxError, std::abs(a[i] - b[i]));
+                }
+            }
+
+            std::printf("serial %.1f ms, speed-up %.2fx, max deviation %.1f dB\n", serialTime,
+                        serialTime / juce::jmax(1.0e-3, parallelTime), juce::Decibels::gainToDecibels(maxError, -200.f));
+        }
+
+        options.outputFile.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream(options.outputFile.createOutputStream());
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        if (stream != nullptr) {
+            writer.reset(juce::WavAudioFormat().createWriterFor(stream.get(), sampleRate, (unsigned int)output.getNumChannels(), 24, {}, 0));
+        }
+
+        if (writer == nullptr) {
+            std::printf("can't write %s\n", options.outputFile.getFullPathName().toRawUTF8());
+            return false;
+        }
+
+        // The writer owns the stream from here.
+        stream.release();
+
+        return writer->writeFromAudioSampleBuffer(output, 0, output.getNumSamples());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    auto options = parseOptions(args);
+    TestSignal signal(options.sampleRate);
+
+    if (options.traceFile != juce::File()) {
+        TraceRecorder::getInstance().start();
+    }
+
+    // Writes the trace however the run ends.
+    auto finish = [&options](int result)
+        {
+            if (options.traceFile != juce::File()) {
+                TraceRecorder::getInstance().stop();
+                TraceRecorder::getInstance().writeTrace(options.traceFile);
+            }
+
+            return result;
+        };
+
+    if (options.bench) {
+        runBenchmarks(options, signal);
+        return finish(0);
+    }
+
+    if (options.regression) {
+        return finish(runRegression() == 0 ? 0 : 1);
+    }
+
+    if (options.renderFile != juce::File()) {
+        return finish(runRender(options) ? 0 : 1);
+    }
+
+    std::printf("block %d @ %.0f Hz, backend %s, precision %s, %s host, automation %.2f%s%s%s\n",
+                options.blockSize, options.sampleRate, getBackendName(options.backend), getPrecisionName(options.precision),
+                options.doubleHost ? "double" : "float", options.automationRate,
+                options.morph ? ", morphing" : "", options.editors ? ", editors open" : "",
+                options.freewheel ? ", freewheeling" : "");
+
+    if (options.numInstances > 0) {
+        return finish(report(runTrial(options, options.numInstances, signal)) ? 0 : 1);
+    }
+
+    std::printf("maximum sustainable instances: %d\n", findMaxInstances(options, signal));
+
+    return finish(0);
+}
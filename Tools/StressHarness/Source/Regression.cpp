@@ -0,0 +1,356 @@
+#include "Regression.h"
+#include "../../../Source/PluginProcessor.h"
+
+#include <cstdio>
+
+namespace
+{
+    // Renders are 2^16 samples, long enough for the slowest cut to ring out at every rate.
+    constexpr int renderOrder = 16;
+    constexpr int renderLength = 1 << renderOrder;
+    constexpr int blockSize = 256;
+
+    // Every path is compared against JUCE's own IIR::Filter running JUCE's designs: the float bands
+    // in float, as the original ProcessorChain did, and the bands a precision mode moves to double
+    // in double, ahead of the float ones as FilterEngine runs them. The largest deviation is
+    // relative to the reference's peak.
+    // The scalar float cascade does the same arithmetic as IIR::Filter in the same order, so only
+    // JUCE's denormal snapping tells them apart. The block-parallel form reassociates, which costs
+    // it about the float path's own rounding. Double sections come from our own designer; with
+    // JUCE's designs in double the only gap left should be the output's rounding to float, a
+    // single float step (about -140dB of full scale), so a designer that drifts shows up.
+    struct Path
+    {
+        ProcessingBackend backend;
+        PrecisionMode precision;
+        const char* name;
+        double toleranceInDecibels;
+    };
+
+    const Path paths[] =
+    {
+        { ProcessingBackend::MonoChain,     PrecisionMode::Float,  "chain/float",     -120.0 },
+        { ProcessingBackend::MonoChain,     PrecisionMode::Mixed,  "chain/mixed",     -120.0 },
+        { ProcessingBackend::MonoChain,     PrecisionMode::Double, "chain/double",    -130.0 },
+       #if JUCE_USE_SIMD
+        { ProcessingBackend::BlockParallel, PrecisionMode::Float,  "parallel/float",   -90.0 },
+        { ProcessingBackend::BlockParallel, PrecisionMode::Mixed,  "parallel/mixed",   -90.0 },
+        { ProcessingBackend::BlockParallel, PrecisionMode::Double, "parallel/double", -130.0 },
+       #endif
+    };
+
+    // Measured against analytic magnitude, at points where the analytic response is above the floor.
+    constexpr double magnitudeToleranceInDecibels = 0.1;
+    constexpr double magnitudeFloorInDecibels = -60.0;
+    constexpr int numMagnitudePoints = 200;
+
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0 };
+
+    struct Case
+    {
+        const char* name;
+        ChainSettings settings;
+    };
+
+    ChainSettings makeSettings(float peakFreq, float peakGain, float peakQuality, float lowCut, Slope lowSlope, float highCut, Slope highSlope)
+    {
+        ChainSettings settings;
+        settings.peakFreq = peakFreq;
+        settings.peakGainInDecibels = peakGain;
+        settings.peakQuality = peakQuality;
+        settings.lowCutFreq = lowCut;
+        settings.lowCutSlope = lowSlope;
+        settings.highCutFreq = highCut;
+        settings.highCutSlope = highSlope;
+        return settings;
+    }
+
+    std::vector<Case> makeCases()
+    {
+        std::vector<Case> cases =
+        {
+            { "flat",         makeSettings(750.f, 0.f, 1.f, 20.f, Slope_12, 20000.f, Slope_12) },
+            { "mid-boost",    makeSettings(1000.f, 12.f, 1.f, 100.f, Slope_24, 8000.f, Slope_48) },
+            { "low-notch",    makeSettings(120.f, -18.f, 4.f, 30.f, Slope_48, 15000.f, Slope_12) },
+            { "sub-peak",     makeSettings(40.f, 6.f, 0.5f, 20.f, Slope_36, 20000.f, Slope_36) },
+            { "air",          makeSettings(12000.f, 24.f, 10.f, 250.f, Slope_12, 18000.f, Slope_24) },
+            { "narrow-band",  makeSettings(2500.f, -24.f, 0.1f, 1500.f, Slope_48, 3500.f, Slope_48) },
+        };
+
+        // Every slope on both cuts.
+        for (auto slope : { Slope_12, Slope_24, Slope_36, Slope_48 }) {
+            static const char* names[] = { "slopes-12", "slopes-24", "slopes-36", "slopes-48" };
+            cases.push_back({ names[slope], makeSettings(1000.f, 0.f, 1.f, 60.f, slope, 10000.f, slope) });
+        }
+
+        return cases;
+    }
+
+    void setParameter(SimpleEQAudioProcessor& processor, const juce::String& parameterID, float value)
+    {
+        if (auto* parameter = processor.apvts.getParameter(parameterID)) {
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        }
+    }
+
+    std::vector<float> makeImpulse()
+    {
+        std::vector<float> signal(renderLength, 0.f);
+        signal[0] = 1.f;
+        return signal;
+    }
+
+    // Exponential sweep from 20Hz to 20kHz (or 0.45 fs) over the whole render, at -6dBFS.
+    std::vector<float> makeSweep(double sampleRate)
+    {
+        std::vector<float> signal(renderLength);
+
+        const auto f1 = 20.0;
+        const auto f2 = juce::jmin(20000.0, 0.45 * sampleRate);
+        const auto duration = renderLength / sampleRate;
+        const auto rate = std::log(f2 / f1);
+
+        for (int i = 0; i < renderLength; ++i) {
+            auto t = i / sampleRate;
+            auto phase = juce::MathConstants<double>::twoPi * f1 * duration / rate * (std::exp(t / duration * rate) - 1.0);
+            signal[(size_t)i] = 0.5f * (float)std::sin(phase);
+        }
+
+        return signal;
+    }
+
+    // Returns the settings the parameters actually landed on, which the analytic curve has to use.
+    ChainSettings render(const ChainSettings& settings, double sampleRate, const Path& path, const std::vector<float>& input, std::vector<float>& output)
+    {
+        SimpleEQAudioProcessor processor;
+
+        setParameter(processor, LOW_CUT_FREQ_PARAM_NAME, settings.lowCutFreq);
+        setParameter(processor, LOW_CUT_SLOPE_PARAM_NAME, (float)settings.lowCutSlope);
+        setParameter(processor, PEAK_FREQ_PARAM_NAME, settings.peakFreq);
+        setParameter(processor, PEAK_GAIN_PARAM_NAME, settings.peakGainInDecibels);
+        setParameter(processor, PEAK_QUALITY_PARAM_NAME, settings.peakQuality);
+        setParameter(processor, HIGH_CUT_FREQ_PARAM_NAME, settings.highCutFreq);
+        setParameter(processor, HIGH_CUT_SLOPE_PARAM_NAME, (float)settings.highCutSlope);
+
+        processor.setProcessingBackend(path.backend);
+        processor.setPrecisionMode(path.precision);
+        processor.setNonRealtime(true);
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        auto numChannels = juce::jmax(2, processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        juce::MidiBuffer midi;
+
+        output.resize(input.size());
+
+        for (int start = 0; start < renderLength; start += blockSize) {
+            buffer.clear();
+            buffer.copyFrom(0, 0, input.data() + start, blockSize);
+            buffer.copyFrom(1, 0, input.data() + start, blockSize);
+
+            processor.processBlock(buffer, midi);
+
+            std::copy(buffer.getReadPointer(0), buffer.getReadPointer(0) + blockSize, output.begin() + start);
+        }
+
+        processor.releaseResources();
+        return getChainSettings(processor.apvts);
+    }
+
+    // The rule FilterEngine uses to move a band to double in PrecisionMode::Mixed.
+    bool runsInDouble(PrecisionMode precision, float frequency, double sampleRate)
+    {
+        return precision == PrecisionMode::Double
+            || (precision == PrecisionMode::Mixed && frequency < sampleRate / 200.0);
+    }
+
+    template<typename FloatType>
+    struct ReferenceBand
+    {
+        using Filter = juce::dsp::IIR::Filter<FloatType>;
+        using Coefficients = juce::dsp::IIR::Coefficients<FloatType>;
+        using Design = juce::dsp::FilterDesign<FloatType>;
+
+        juce::OwnedArray<Filter> filters;
+
+        ReferenceBand(ChainPositions band, const ChainSettings& settings, double sampleRate)
+        {
+            juce::ReferenceCountedArray<Coefficients> sections;
+
+            if (band == ChainPositions::Peak) {
+                sections.add(Coefficients::makePeakFilter(sampleRate, settings.peakFreq, settings.peakQuality,
+                                                          juce::Decibels::decibelsToGain((FloatType)settings.peakGainInDecibels)));
+            } else if (band == ChainPositions::LowCut) {
+                sections = Design::designIIRHighpassHighOrderButterworthMethod(settings.lowCutFreq, sampleRate, 2 * (settings.lowCutSlope + 1));
+            } else {
+                sections = Design::designIIRLowpassHighOrderButterworthMethod(settings.highCutFreq, sampleRate, 2 * (settings.highCutSlope + 1));
+            }
+
+            for (auto* section : sections) {
+                filters.add(new Filter(section));
+            }
+        }
+
+        // In host-sized blocks, as the chain ran, so JUCE's per-block denormal snapping lands in the same places.
+        void process(std::vector<FloatType>& samples)
+        {
+            for (int start = 0; start < renderLength; start += blockSize) {
+                FloatType* channels[] = { samples.data() + start };
+                juce::dsp::AudioBlock<FloatType> block(channels, 1, (size_t)blockSize);
+
+                for (auto* filter : filters) {
+                    filter->process(juce::dsp::ProcessContextReplacing<FloatType>(block));
+                }
+            }
+        }
+    };
+
+    std::vector<float> renderReference(const ChainSettings& settings, double sampleRate, PrecisionMode precision, const std::vector<float>& input)
+    {
+        const ChainPositions bands[] = { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut };
+        const float frequencies[] = { settings.lowCutFreq, settings.peakFreq, settings.highCutFreq };
+
+        std::vector<double> wide(input.begin(), input.end());
+
+        for (int i = 0; i < 3; ++i) {
+            if (runsInDouble(precision, frequencies[i], sampleRate)) {
+                ReferenceBand<double>(bands[i], settings, sampleRate).process(wide);
+            }
+        }
+
+        std::vector<float> output(wide.begin(), wide.end());
+
+        for (int i = 0; i < 3; ++i) {
+            if (!runsInDouble(precision, frequencies[i], sampleRate)) {
+                ReferenceBand<float>(bands[i], settings, sampleRate).process(output);
+            }
+        }
+
+        return output;
+    }
+
+    // Deviation from the reference render in dB relative to the reference's peak.
+    double compare(const std::vector<float>& output, const std::vector<float>& reference)
+    {
+        float peak = 0, error = 0;
+
+        for (size_t i = 0; i < reference.size(); ++i) {
+            peak = juce::jmax(peak, std::abs(reference[i]));
+            error = juce::jmax(error, std::abs(output[i] - reference[i]));
+        }
+
+        return juce::Decibels::gainToDecibels((double)error / juce::jmax(1.0e-12, (double)peak), -300.0);
+    }
+
+    // Worst deviation of the impulse's spectrum from the analytic magnitude, in dB.
+    double compareMagnitude(const std::vector<float>& impulseResponse, const ChainSettings& settings, double sampleRate)
+    {
+        juce::dsp::FFT fft(renderOrder);
+        std::vector<float> spectrum((size_t)renderLength * 2, 0.f);
+        std::copy(impulseResponse.begin(), impulseResponse.end(), spectrum.begin());
+
+        fft.performFrequencyOnlyForwardTransform(spectrum.data());
+
+        auto coefficients = makeChainCoefficients(settings, sampleRate);
+        const auto binWidth = sampleRate / renderLength;
+        double worst = 0;
+
+        for (int i = 0; i < numMagnitudePoints; ++i) {
+            auto frequency = juce::mapToLog10(double(i) / (numMagnitudePoints - 1), 20.0, juce::jmin(20000.0, 0.45 * sampleRate));
+            auto bin = juce::roundToInt(frequency / binWidth);
+
+            auto expected = juce::Decibels::gainToDecibels(coefficients->getMagnitudeForFrequency(bin * binWidth), -300.0);
+
+            if (expected < magnitudeFloorInDecibels) {
+                continue;
+            }
+
+            auto measured = juce::Decibels::gainToDecibels((double)spectrum[(size_t)bin], -300.0);
+            worst = juce::jmax(worst, std::abs(measured - expected));
+        }
+
+        return worst;
+    }
+
+    // A full-scale 997Hz sine in one channel reads -3.01 LUFS (BS.1770). The meter is
+    // prepared at another rate first, so a re-prepare that leaves state behind shows up too.
+    int checkLoudness()
+    {
+        int numFailures = 0;
+
+        for (auto sampleRate : sampleRates) {
+            LoudnessMeter meter;
+            meter.prepare(sampleRate == 96000.0 ? 44100.0 : 96000.0);
+            meter.prepare(sampleRate);
+
+            const auto length = juce::roundToInt(sampleRate * 3);
+            juce::AudioBuffer<float> buffer(2, length);
+            buffer.clear();
+
+            for (int i = 0; i < length; ++i) {
+                buffer.setSample(0, i, (float)std::sin(juce::MathConstants<double>::twoPi * 997.0 * i / sampleRate));
+            }
+
+            meter.process(buffer, length);
+
+            auto error = std::abs(meter.getShortTermLoudness() - -3.01f);
+
+            if (error > 0.05f) {
+                ++numFailures;
+                std::printf("FAIL loudness %6.0f Hz  %8.2f LUFS (expected -3.01)\n", sampleRate, meter.getShortTermLoudness());
+            }
+        }
+
+        return numFailures;
+    }
+}
+
+int runRegression()
+{
+    const auto cases = makeCases();
+    const auto impulse = makeImpulse();
+
+    int numFailures = 0, numChecks = 0;
+
+    auto check = [&](bool passed, const char* what, const Case& c, double sampleRate, const char* path, double value, double tolerance)
+        {
+            ++numChecks;
+
+            if (!passed) {
+                ++numFailures;
+                std::printf("FAIL %-12s %-14s %6.0f Hz  %-16s %8.2f dB (limit %.2f)\n", what, c.name, sampleRate, path, value, tolerance);
+            }
+        };
+
+    for (const auto& c : cases) {
+        for (auto sampleRate : sampleRates) {
+            const auto sweep = makeSweep(sampleRate);
+            const std::pair<const char*, const std::vector<float>*> signals[] = { { "impulse", &impulse }, { "sweep", &sweep } };
+
+            for (const auto& [name, signal] : signals) {
+                for (const auto& path : paths) {
+                    std::vector<float> output;
+                    auto settings = render(c.settings, sampleRate, path, *signal, output);
+                    auto deviation = compare(output, renderReference(settings, sampleRate, path.precision, *signal));
+
+                    check(deviation <= path.toleranceInDecibels, name, c, sampleRate, path.name, deviation, path.toleranceInDecibels);
+
+                    if (signal == &impulse) {
+                        auto magnitudeError = compareMagnitude(output, settings, sampleRate);
+                        check(magnitudeError <= magnitudeToleranceInDecibels, "magnitude", c, sampleRate, path.name,
+                              magnitudeError, magnitudeToleranceInDecibels);
+                    }
+                }
+            }
+        }
+    }
+
+    auto loudnessFailures = checkLoudness();
+    numChecks += (int)std::size(sampleRates);
+    numFailures += loudnessFailures;
+
+    std::printf("regression: %d checks, %d failed\n", numChecks, numFailures);
+
+    return numFailures;
+}
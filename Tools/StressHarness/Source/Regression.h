@@ -0,0 +1,14 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Regression check for the filter paths.
+//
+// For a grid of settings and sample rates, every backend and precision renders an impulse and a
+// sine sweep, which are compared against a reference built from JUCE's IIR::Filter and
+// FilterDesign alone: the ProcessorChain the MonoChain backend started out as, with the bands a
+// precision mode runs in double done in double. The impulse's measured magnitude response is
+// also compared against the analytic curve the editor draws (ChainCoefficients::getMagnitudeForFrequency).
+// Also checks the loudness meter against the BS.1770 reference level.
+// Returns the number of failed checks.
+int runRegression();